@@ -15,7 +15,6 @@ void testApp::setup(){
 	#endif
 	
 	colorImage.allocate(width, height);
-	grayImage.allocate(width, height);
 	grayThres.allocate(width, height);
 	
 	// Load the image we are going to distort
@@ -68,14 +67,16 @@ void testApp::update(){
 		colorImage.setFromPixels(vidPlayer.getPixels(), width, height);
 		#endif
 		
-		// convert our camera image to grayscale
-		grayImage = colorImage;
 		// apply a threshold so we can see what is going on
-		grayThres = grayImage;
+		grayThres = colorImage;
 		grayThres.threshold(threshold);
 		
 		// Pass in the new image pixels to artk
-		artk.update(grayImage.getPixels());
+		// It converts them to grayscale itself
+		artk.update(colorImage.getPixels(), ARToolKitPlus::PIXEL_FORMAT_RGB);
+		// Solve the poses of all markers up front
+		// so drawing them later on does not have to
+		artk.solveAllPoses();
 		
 	}
 	
@@ -86,9 +87,12 @@ void testApp::draw(){
 	
 	// Main image
 	ofSetHexColor(0xffffff);
-	grayImage.draw(0, 0);
+	colorImage.draw(0, 0);
 	ofSetHexColor(0x666666);	
 	ofDrawBitmapString(ofToString(artk.getNumDetectedMarkers()) + " marker(s) found", 10, 20);
+	ofDrawBitmapString("Pose solve: " + ofToString(artk.getLastPoseSolveMicros()) + "us", 10, 40);
+	ofDrawBitmapString("Labeling: " + ofToString(artk.getLastLabelMicros()) + "us on " + ofToString(artk.getNumLabelThreads()) + " thread(s)", 10, 60);
+	ofDrawBitmapString("Use the 'l' key to change the number of label threads", 10, 80);
 
 	// Threshold image
 	ofSetHexColor(0xffffff);
@@ -172,6 +176,10 @@ void testApp::keyPressed(int key){
 		
 	} else if(key == OF_KEY_DOWN) {
 		artk.setThreshold(--threshold);		
+	} else if(key == 'l') {
+		// Cycle through 1, 2, 4 and 8 label threads to compare the timings
+		int numThreads = artk.getNumLabelThreads() * 2;
+		artk.setNumLabelThreads(numThreads > 8 ? 1 : numThreads);
 	}
 	#ifdef CAMERA_CONNECTED
 	if(key == 's') {
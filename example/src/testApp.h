@@ -40,7 +40,6 @@ class testApp : public ofBaseApp{
 	
 		/* OpenCV images */
 		ofxCvColorImage colorImage;
-		ofxCvGrayscaleImage grayImage;
 		ofxCvGrayscaleImage	grayThres;
 	
 		/* Image to distort on to the marker */
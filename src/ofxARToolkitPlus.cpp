@@ -1,8 +1,8 @@
 
 #include "ofxARToolkitPlus.h"
 
+#include "ARToolKitPlus/extra/rpp.h"
 
-ARToolKitPlus::ARMultiMarkerInfoT * multiMarker;
 
 //class MyLogger : public ARToolKitPlus::Logger
 //{
@@ -16,12 +16,35 @@ ARToolKitPlus::ARMultiMarkerInfoT * multiMarker;
 
 ofxARToolkitPlus::ofxARToolkitPlus() {
 	multiMarkerLoaded = false;
+	multiMarker = NULL;
+	drawBorders = false;
+	overlayDirty = true;
+	multiMarkerPoseConfig = NULL;
+	multiMarkerPoseValid = false;
+	memset(multiMarkerTrans, 0, sizeof(multiMarkerTrans));
+	poseCacheHits = 0;
+	poseCacheMisses = 0;
+	lastPoseSolveMicros = 0;
+	// Identity pose with a negative error, returned for marker indices that were not detected
+	memset(&invalidPose, 0, sizeof(invalidPose));
+	for(int i=0; i<3; i++) {
+		invalidPose.trans[i][i] = 1;
+	}
+	invalidPose.error = -1;
+	invalidPose.estimator = ARToolKitPlus::POSE_ESTIMATOR_RPP;
+	warmStartPose = false;
+	warmStartMaxIterations = 5;
+	// Cold solves of a 40mm marker at any angle stay below an error of 2.6
+	warmStartMaxError = 0.125;
+	poseWarmStarts = 0;
+	poseColdStarts = 0;
 }
 
 ofxARToolkitPlus::~ofxARToolkitPlus() {
-	// This must be static so don't delete it when using multiple instances
-	// TODO: Keep count of instances, and delete final one.
-	//if( tracker != NULL ) { delete tracker; }
+	// The tracker itself goes with the shared_ptr
+	if(multiMarkerLoaded) {
+		tracker->arMultiFreeConfig(multiMarker);
+	}
 }
 
 
@@ -42,6 +65,17 @@ void ofxARToolkitPlus::setup(int w, int h, string camParamFile, string multiFile
 	halfMarkerWidth = markerWidth/2;
 	c[0] = 0;
 	c[1] = 0;
+	poseCache.assign(maxImagePatterns, CachedPose());
+	invalidatePoseCache();
+	previousPoses.clear();
+	previousPoses.reserve(maxImagePatterns);
+	multiMarkerPoseInput.reserve(maxImagePatterns);
+	multiMarkerPoseConfig = NULL;
+	multiMarkerPoseValid = false;
+	grayPixels.resize(w * h);
+	markerIndexByID.assign(MAX_MARKER_ID + 1, -1);
+	indexedMarkerIDs.clear();
+	indexedMarkerIDs.reserve(maxImagePatterns);
 	
 	// ----------------------------------  AR TK+ STUFF - ripped from the single marker demo app
     
@@ -51,7 +85,9 @@ void ofxARToolkitPlus::setup(int w, int h, string camParamFile, string multiFile
     //  - works with luminance (gray) images
     //  - can load a maximum of "maxLoadPatterns" non-binary pattern
     //  - can detect a maximum of "maxImagePatterns" patterns in one image
-    tracker = make_shared<ARToolKitPlus::TrackerMultiMarker>(width, height, maxImagePatterns, pattWidth, pattHeight, pattSamples, maxLoadPatterns);
+    // The constructor and init() write the camera size statics all trackers share
+    std::unique_lock<std::mutex> setupLock(ofxARToolkitPlusTracker::getLibraryMutex());
+    tracker = make_shared<ofxARToolkitPlusTracker>(width, height, maxImagePatterns, pattWidth, pattHeight, pattSamples, maxLoadPatterns);
 //	const char* description = tracker->getDescription();
 //	printf("ARToolKitPlus compile-time information:\n%s\n\n", description);
 	
@@ -75,6 +111,7 @@ void ofxARToolkitPlus::setup(int w, int h, string camParamFile, string multiFile
 	
 		return;
 	}
+	setupLock.unlock();
 	tracker->getCamera()->printSettings();
     // define size of the marker
     //tracker->setPatternWidth(80); // I'm not sure how to define the size with multimarkers since it doesnt seem to have this option.
@@ -103,13 +140,141 @@ void ofxARToolkitPlus::setup(int w, int h, string camParamFile, string multiFile
 	
 	tracker->setUseDetectLite(false);
 	
+	tracker->setDetectionROIs(detectionROIs.data(), detectionROIs.size());
+	
 	setupHomoSrc();
 	
 }
 
 //--------------------------------------------------
 int ofxARToolkitPlus::update(unsigned char *pixels) {
-	return tracker->calc(pixels);
+	return track(pixels);
+}
+
+int ofxARToolkitPlus::update(const unsigned char *pixels, ARToolKitPlus::PIXEL_FORMAT format) {
+	if(format == ARToolKitPlus::PIXEL_FORMAT_LUM) {
+		return track(pixels);
+	}
+	ofxARToolkitPlusConvertToGray(pixels, &grayPixels[0], width * height, format);
+	return track(&grayPixels[0]);
+}
+
+int ofxARToolkitPlus::update(ofPixels &pixels) {
+	if(pixels.getWidth() != width || pixels.getHeight() != height) {
+		ofLog(OF_LOG_ERROR, "ofxARToolkitPlus: pixels are " + ofToString(pixels.getWidth()) + "x" + ofToString(pixels.getHeight()) + ", not " + ofToString(width) + "x" + ofToString(height));
+		return 0;
+	}
+	InputFormat format;
+	switch(pixels.getPixelFormat()) {
+		case OF_PIXELS_GRAY:
+		case OF_PIXELS_Y:		format = INPUT_GRAY;	break;
+		case OF_PIXELS_RGB:		format = INPUT_RGB;		break;
+		case OF_PIXELS_BGR:		format = INPUT_BGR;		break;
+		case OF_PIXELS_RGBA:	format = INPUT_RGBA;	break;
+		case OF_PIXELS_BGRA:	format = INPUT_BGRA;	break;
+		case OF_PIXELS_RGB565:	format = INPUT_RGB565;	break;
+		// Only the Y plane in front is read, the order of the chroma planes does not matter
+		case OF_PIXELS_NV12:
+		case OF_PIXELS_NV21:	format = INPUT_NV12;	break;
+		case OF_PIXELS_I420:
+		case OF_PIXELS_YV12:	format = INPUT_I420;	break;
+		case OF_PIXELS_YUY2:	format = INPUT_YUYV;	break;
+		case OF_PIXELS_UYVY:	format = INPUT_UYVY;	break;
+		default:
+			ofLog(OF_LOG_ERROR, "ofxARToolkitPlus: unsupported pixel format " + ofToString(pixels.getPixelFormat()));
+			return 0;
+	}
+	return update(InputImage(pixels.getPixels(), format));
+}
+
+int ofxARToolkitPlus::update(const InputImage &image) {
+	return track(getGrayPixels(image));
+}
+
+int ofxARToolkitPlus::update(unsigned char *pixels, const ofRectangle &roi) {
+	tracker->setDetectionROIs(&roi, 1);
+	int result = track(pixels);
+	tracker->setDetectionROIs(detectionROIs.data(), detectionROIs.size());
+	return result;
+}
+
+int ofxARToolkitPlus::track(const unsigned char *pixels) {
+	keepPreviousPoses();
+	invalidatePoseCache();
+	multiMarkerPoseValid = false;
+	int result = tracker->calc(pixels);
+	indexDetectedMarkers();
+	if(!multiMarkerLoaded) {
+		solveMultiMarkerPose();
+	}
+	overlayDirty = true;
+	return result;
+}
+
+const unsigned char* ofxARToolkitPlus::getGrayPixels(const InputImage &image) {
+	
+	// How the Y samples or colors sit in a row
+	ARToolKitPlus::PIXEL_FORMAT format = ARToolKitPlus::PIXEL_FORMAT_LUM;
+	int bytesPerPixel = 1;
+	int lumaOffset = -1;
+	switch(image.format) {
+		case INPUT_GRAY:
+		case INPUT_NV12:
+		case INPUT_I420:
+			break;
+		case INPUT_YUYV:
+			bytesPerPixel = 2;
+			lumaOffset = 0;
+			break;
+		case INPUT_UYVY:
+			bytesPerPixel = 2;
+			lumaOffset = 1;
+			break;
+		case INPUT_RGB:		format = ARToolKitPlus::PIXEL_FORMAT_RGB;		break;
+		case INPUT_BGR:		format = ARToolKitPlus::PIXEL_FORMAT_BGR;		break;
+		case INPUT_RGBA:	format = ARToolKitPlus::PIXEL_FORMAT_RGBA;		break;
+		case INPUT_BGRA:	format = ARToolKitPlus::PIXEL_FORMAT_BGRA;		break;
+		case INPUT_ABGR:	format = ARToolKitPlus::PIXEL_FORMAT_ABGR;		break;
+		case INPUT_RGB565:	format = ARToolKitPlus::PIXEL_FORMAT_RGB565;	break;
+	}
+	if(format != ARToolKitPlus::PIXEL_FORMAT_LUM) {
+		bytesPerPixel = ofxARToolkitPlusGetBytesPerPixel(format);
+	}
+	int stride = image.stride > 0 ? image.stride : width * bytesPerPixel;
+	
+	// A packed Y plane is exactly what the tracker reads
+	if(bytesPerPixel == 1 && stride == width) {
+		return image.pixels;
+	}
+	
+	for(int y=0; y<height; y++) {
+		const unsigned char *src = image.pixels + y * stride;
+		unsigned char *dst = &grayPixels[y * width];
+		if(lumaOffset >= 0) {
+			ofxARToolkitPlusExtractLuma(src + lumaOffset, dst, width);
+		} else {
+			ofxARToolkitPlusConvertToGray(src, dst, width, format);
+		}
+	}
+	return &grayPixels[0];
+}
+
+void ofxARToolkitPlus::indexDetectedMarkers() {
+	for(size_t i=0; i<indexedMarkerIDs.size(); i++) {
+		markerIndexByID[indexedMarkerIDs[i]] = -1;
+	}
+	indexedMarkerIDs.clear();
+	
+	int numDetected = tracker->getNumDetectedMarkers();
+	for(int i=0; i<numDetected; i++) {
+		int id = tracker->getDetectedMarker(i).id;
+		// Keep the first index if the same marker was seen twice
+		if(id < 0 || id > MAX_MARKER_ID || markerIndexByID[id] >= 0) {
+			continue;
+		}
+		markerIndexByID[id] = i;
+		indexedMarkerIDs.push_back(id);
+	}
 }
 
 //--------------------------------------------------
@@ -131,51 +296,83 @@ void ofxARToolkitPlus::draw(int x, int y, int w, int h) {
 	glScalef(scaleX, scaleY, 1);
 	ofSetLineWidth(1);
 	
-	int numDetected = tracker->getNumDetectedMarkers();
+	// Centers and outlines in one go, the colors come from the mesh
+	getOverlayMesh().draw();
 	
+	// Draw the marker IDs
+	ofSetColor( 255, 255, 255 );
+	int numDetected = tracker->getNumDetectedMarkers();
 	for(int i=0; i<numDetected; i++) {
-		
-		ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(i);
-		
-		// Draw the center point
-		ofFill();
-		ofSetColor(255, 0, 255 );
-		ofRect(marker.pos[0]-1, marker.pos[1]-1, 2, 2);
-		
-		// Draw the inner rectangle
-		ofNoFill();
-		ofSetColor(255, 255, 0 );		
-		ofBeginShape();
-		ofVertex(marker.vertex[0][0], marker.vertex[0][1]);
-		ofVertex(marker.vertex[1][0], marker.vertex[1][1]);
-		ofVertex(marker.vertex[2][0], marker.vertex[2][1]);
-		ofVertex(marker.vertex[3][0], marker.vertex[3][1]);
-		ofEndShape(true);
-		
-		// Draw the marker ID
-		ofSetColor( 255, 255, 255 );	
+		const ARToolKitPlus::ARMarkerInfo &marker = tracker->getDetectedMarker(i);
 		ofDrawBitmapString(ofToString(marker.id), marker.pos[0], marker.pos[1]);
-		
-		// Draw the outer rectangle
-//		ofPoint center(marker.pos[0], marker.pos[1]);
-//		ofNoFill();
-//		ofSetColor(255, 0, 0 );		
-//		ofBeginShape();
-//		for (int j=0; j<4; j++) {
-//			ofPoint corner(marker.vertex[j][0], marker.vertex[j][1]);
-//			corner -= center;
-//			corner *= BORDER_SCALE;
-//			corner += center;
-//			ofVertex(corner.x, corner.y);
-//		}
-//		ofEndShape(true);
-		
 	}
 	
 	glPopMatrix();
 	
 }
 
+void ofxARToolkitPlus::setDrawBorders(bool state) {
+	if(drawBorders != state) {
+		drawBorders = state;
+		overlayDirty = true;
+	}
+}
+
+const ofMesh& ofxARToolkitPlus::getOverlayMesh() {
+	if(overlayDirty) {
+		buildOverlayMesh(getDetectedMarkerInfos(), tracker->getNumDetectedMarkers(), drawBorders, overlayMesh);
+		overlayDirty = false;
+	}
+	return overlayMesh;
+}
+
+// Add the outline of a quad as four line segments
+static void addQuadOutline(ofMesh &mesh, const ofPoint corners[4], const ofFloatColor &color) {
+	for(int j=0; j<4; j++) {
+		mesh.addVertex(corners[j]);
+		mesh.addVertex(corners[(j + 1) % 4]);
+		mesh.addColor(color);
+		mesh.addColor(color);
+	}
+}
+
+void ofxARToolkitPlus::buildOverlayMesh(const ARToolKitPlus::ARMarkerInfo *markers, int count, bool borders, ofMesh &mesh) {
+	
+	// clear() keeps the capacity, so a reused mesh stops allocating once it has seen the most markers
+	mesh.clear();
+	mesh.setMode(OF_PRIMITIVE_LINES);
+	
+	for(int i=0; i<count; i++) {
+		
+		const ARToolKitPlus::ARMarkerInfo &marker = markers[i];
+		ofPoint center(marker.pos[0], marker.pos[1]);
+		ofPoint corners[4];
+		
+		// The center point
+		corners[0].set(center.x - 1, center.y - 1);
+		corners[1].set(center.x + 1, center.y - 1);
+		corners[2].set(center.x + 1, center.y + 1);
+		corners[3].set(center.x - 1, center.y + 1);
+		addQuadOutline(mesh, corners, ofFloatColor(1, 0, 1));
+		
+		// The inner rectangle
+		for (int j=0; j<4; j++) {
+			corners[j].set(marker.vertex[j][0], marker.vertex[j][1]);
+		}
+		addQuadOutline(mesh, corners, ofFloatColor(1, 1, 0));
+		
+		// The outer rectangle
+		if(borders) {
+			for (int j=0; j<4; j++) {
+				corners[j] -= center;
+				corners[j] *= BORDER_SCALE;
+				corners[j] += center;
+			}
+			addQuadOutline(mesh, corners, ofFloatColor(1, 0, 0));
+		}
+	}
+}
+
 //--------------------------------------------------
 void ofxARToolkitPlus::applyProjectionMatrix(int viewportWidth, int viewportHeight){
 	glViewport(0, 0, viewportWidth, viewportHeight );
@@ -194,30 +391,10 @@ void ofxARToolkitPlus::applyProjectionMatrix(){
 
 void ofxARToolkitPlus::applyModelMatrix(int markerIndex) {
 
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-	
-	getTransMat( &marker, c, m34 );
+	const CachedPose &pose = getCachedPose(markerIndex);
 	
 	// Convert from ARTK matrix to OpenGL format
-	m[0] = m34[0][0];
-	m[1] = m34[1][0];	
-	m[2] = m34[2][0];		
-	m[3] = 0;			
-
-	m[4] = m34[0][1];
-	m[5] = m34[1][1];	
-	m[6] = m34[2][1];		
-	m[7] = 0;	
-
-	m[8] = m34[0][2];
-	m[9] = m34[1][2];	
-	m[10] = m34[2][2];		
-	m[11] = 0;	
-	
-	m[12] = m34[0][3];
-	m[13] = m34[1][3];	
-	m[14] = m34[2][3];		
-	m[15] = 1;	
+	convertToGLMatrix(pose.trans, m);
 		
 	glMatrixMode( GL_MODELVIEW );
 	glLoadMatrixf( m );
@@ -225,92 +402,200 @@ void ofxARToolkitPlus::applyModelMatrix(int markerIndex) {
 }
 
 ofMatrix4x4 ofxARToolkitPlus::getMatrix(int markerIndex) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-	
-	getTransMat( &marker, c, m34 );
+	const CachedPose &pose = getCachedPose(markerIndex);
 
-	ofMatrix4x4 matrix(m34[0][0], m34[0][1], m34[0][2], m34[0][3],
-						m34[1][0], m34[1][1], m34[1][2], m34[1][3],
-						m34[2][0], m34[2][1], m34[2][2], m34[2][3],
+	ofMatrix4x4 matrix(pose.trans[0][0], pose.trans[0][1], pose.trans[0][2], pose.trans[0][3],
+						pose.trans[1][0], pose.trans[1][1], pose.trans[1][2], pose.trans[1][3],
+						pose.trans[2][0], pose.trans[2][1], pose.trans[2][2], pose.trans[2][3],
 						0, 0, 0, 1);
 	return matrix;
 }
 
 ofMatrix4x4 ofxARToolkitPlus::getGLMatrix(int markerIndex) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-	
-	getTransMat( &marker, c, m34 );
+	const CachedPose &pose = getCachedPose(markerIndex);
 
 	// OpenGL Order
-	ofMatrix4x4 matrix(m34[0][0], m34[1][0], m34[2][0], 0,
-						m34[0][1], m34[1][1], m34[2][1], 0,
-						m34[0][2], m34[1][2], m34[2][2], 0,
-						m34[0][3], m34[1][3], m34[2][3], 1);
+	ofMatrix4x4 matrix(pose.trans[0][0], pose.trans[1][0], pose.trans[2][0], 0,
+						pose.trans[0][1], pose.trans[1][1], pose.trans[2][1], 0,
+						pose.trans[0][2], pose.trans[1][2], pose.trans[2][2], 0,
+						pose.trans[0][3], pose.trans[1][3], pose.trans[2][3], 1);
 	return matrix;
 }
 
 ofMatrix4x4 ofxARToolkitPlus::getHomography(int markerIndex) {
-	vector<ofPoint> corners;
-	getDetectedMarkerOrderedBorderCorners(markerIndex, corners);
-	return findHomography(homoSrc, corners);
+	return getHomography(markerIndex, homoSrc);
 }
 
-ofMatrix4x4 ofxARToolkitPlus::getHomography(int markerIndex, vector<ofPoint> &src) {
-	vector<ofPoint> corners;
-	getDetectedMarkerOrderedBorderCorners(markerIndex, corners);
-	return findHomography(src, corners);
+ofMatrix4x4 ofxARToolkitPlus::getHomography(int markerIndex, const vector<ofPoint> &src) {
+	float homography[16];
+	if(src.size() != 4) {
+		ofLog(OF_LOG_ERROR, "Homography needs 4 src points, not " + ofToString(src.size()));
+		return ofMatrix4x4();
+	}
+	computeHomographies(&src[0], &tracker->getDetectedMarker(markerIndex), 1, homography);
+	return ofMatrix4x4(homography);
 }
 
+int ofxARToolkitPlus::getAllHomographies(float *out, int maxMarkers) {
+	return getAllHomographies(homoSrc, out, maxMarkers);
+}
 
-ofVec3f ofxARToolkitPlus::getTranslation(int markerIndex) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
+int ofxARToolkitPlus::getAllHomographies(const vector<ofPoint> &src, float *out, int maxMarkers) {
+	if(src.size() != 4) {
+		ofLog(OF_LOG_ERROR, "Homography needs 4 src points, not " + ofToString(src.size()));
+		return 0;
+	}
+	int count = std::min(tracker->getNumDetectedMarkers(), maxMarkers);
+	if(count > 0) {
+		computeHomographies(&src[0], &tracker->getDetectedMarker(0), count, out);
+	}
+	return count;
+}
+
+// Markers are gathered into blocks of this many so the maths
+// below runs across markers in straight loops the compiler can vectorize
+#define HOMOGRAPHY_BLOCK 8
+
+void ofxARToolkitPlus::computeHomographies(const ofPoint src[4], const ARToolKitPlus::ARMarkerInfo *markers, int count, float *out) {
+	
+	// Inverse (up to scale) of the unit square to src mapping, the same for every marker
+	float sx[4], sy[4];
+	for(int i=0; i<4; i++) {
+		sx[i] = src[i].x;
+		sy[i] = src[i].y;
+	}
+	ofxARToolkitPlusMatrix<3, 3, float> S;
+	squareToQuad(sx, sy, &S.m[0][0]);
+	ofxARToolkitPlusMatrix<3, 3, float> Si = S.adjugate();
 	
-	getTransMat( &marker, c, m34 );
+	for(int start=0; start<count; start+=HOMOGRAPHY_BLOCK) {
+		int n = std::min(count - start, HOMOGRAPHY_BLOCK);
+		
+		// Ordered border corners of the block, one array per corner coordinate
+		float x[4][HOMOGRAPHY_BLOCK], y[4][HOMOGRAPHY_BLOCK];
+		for(int k=0; k<n; k++) {
+			const ARToolKitPlus::ARMarkerInfo &marker = markers[start + k];
+			for(int i=0; i<4; i++) {
+				int index = (4 - marker.dir + i) % 4;
+				x[i][k] = (marker.vertex[index][0] - marker.pos[0]) * BORDER_SCALE + marker.pos[0];
+				y[i][k] = (marker.vertex[index][1] - marker.pos[1]) * BORDER_SCALE + marker.pos[1];
+			}
+		}
+		
+		// Unit square to marker mapping (see squareToQuad) composed with Si
+		float H[9][HOMOGRAPHY_BLOCK];
+		for(int k=0; k<n; k++) {
+			float dx1 = x[1][k] - x[2][k], dx2 = x[3][k] - x[2][k], dx3 = x[0][k] - x[1][k] + x[2][k] - x[3][k];
+			float dy1 = y[1][k] - y[2][k], dy2 = y[3][k] - y[2][k], dy3 = y[0][k] - y[1][k] + y[2][k] - y[3][k];
+			float det = dx1*dy2 - dx2*dy1;
+			float g = (dx3*dy2 - dx2*dy3) / det;
+			float h = (dx1*dy3 - dx3*dy1) / det;
+			ofxARToolkitPlusMatrix<3, 3, float> D = {{
+				{ x[1][k] - x[0][k] + g*x[1][k], x[3][k] - x[0][k] + h*x[3][k], x[0][k] },
+				{ y[1][k] - y[0][k] + g*y[1][k], y[3][k] - y[0][k] + h*y[3][k], y[0][k] },
+				{ g, h, 1 }
+			}};
+			ofxARToolkitPlusMatrix<3, 3, float> DSi = D * Si;
+			for(int r=0; r<3; r++) {
+				for(int c=0; c<3; c++) {
+					H[r*3+c][k] = DSi(r, c);
+				}
+			}
+		}
+		
+		// Scale so h33 is 1 and write out transposed for OpenGL, z is dropped
+		for(int k=0; k<n; k++) {
+			float scale = 1 / H[8][k];
+			float *gl = out + (start + k) * 16;
+			gl[0] = H[0][k]*scale;	gl[1] = H[3][k]*scale;	gl[2] = 0;	gl[3] = H[6][k]*scale;
+			gl[4] = H[1][k]*scale;	gl[5] = H[4][k]*scale;	gl[6] = 0;	gl[7] = H[7][k]*scale;
+			gl[8] = 0;				gl[9] = 0;				gl[10] = 0;	gl[11] = 0;
+			gl[12] = H[2][k]*scale;	gl[13] = H[5][k]*scale;	gl[14] = 0;	gl[15] = 1;
+		}
+	}
+}
+
+void ofxARToolkitPlus::squareToQuad(const float x[4], const float y[4], float H[9]) {
+	// Projective mapping from the unit square, see
+	// Heckbert, Fundamentals of Texture Mapping and Image Warping, section 2.2.3
+	float dx1 = x[1] - x[2], dx2 = x[3] - x[2], dx3 = x[0] - x[1] + x[2] - x[3];
+	float dy1 = y[1] - y[2], dy2 = y[3] - y[2], dy3 = y[0] - y[1] + y[2] - y[3];
+	float det = dx1*dy2 - dx2*dy1;
+	float g = (dx3*dy2 - dx2*dy3) / det;
+	float h = (dx1*dy3 - dx3*dy1) / det;
+	H[0] = x[1] - x[0] + g*x[1];	H[1] = x[3] - x[0] + h*x[3];	H[2] = x[0];
+	H[3] = y[1] - y[0] + g*y[1];	H[4] = y[3] - y[0] + h*y[3];	H[5] = y[0];
+	H[6] = g;						H[7] = h;						H[8] = 1;
+}
+
+
+ofVec3f ofxARToolkitPlus::getTranslation(int markerIndex) {
+	const CachedPose &pose = getCachedPose(markerIndex);
 	
-	ofVec3f trans(m34[0][3], m34[1][3], m34[2][3]);
+	ofVec3f trans(pose.trans[0][3], pose.trans[1][3], pose.trans[2][3]);
 	return trans;
 }
 
 ofMatrix4x4 ofxARToolkitPlus::getOrientationMatrix(int markerIndex) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-
-	getTransMat( &marker, c, m34 );
+	const CachedPose &pose = getCachedPose(markerIndex);
 	
-	ofMatrix4x4 matrix(m34[0][0], m34[0][1], m34[0][2], 0,
-						m34[1][0], m34[1][1], m34[1][2], 0,
-						m34[2][0], m34[2][1], m34[2][2], 0,
+	ofMatrix4x4 matrix(pose.trans[0][0], pose.trans[0][1], pose.trans[0][2], 0,
+						pose.trans[1][0], pose.trans[1][1], pose.trans[1][2], 0,
+						pose.trans[2][0], pose.trans[2][1], pose.trans[2][2], 0,
 						0, 0, 0, 1);
 	return matrix;
 }
 
 ofQuaternion ofxARToolkitPlus::getOrientationQuaternion(int markerIndex) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
+	const CachedPose &pose = getCachedPose(markerIndex);
 	
-	getTransMat( &marker, c, m34 );
-	
-	ofMatrix4x4 matrix(m34[0][0], m34[0][1], m34[0][2], 0,
-						m34[1][0], m34[1][1], m34[1][2], 0,
-						m34[2][0], m34[2][1], m34[2][2], 0,
+	ofMatrix4x4 matrix(pose.trans[0][0], pose.trans[0][1], pose.trans[0][2], 0,
+						pose.trans[1][0], pose.trans[1][1], pose.trans[1][2], 0,
+						pose.trans[2][0], pose.trans[2][1], pose.trans[2][2], 0,
 						0, 0, 0, 1);
 	return matrix.getRotate();
 }
 
 void ofxARToolkitPlus::getTranslationAndOrientation(int markerIndex, ofVec3f &translation, ofMatrix4x4 &orientation) {
 	
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-
-	getTransMat( &marker, c, m34 );
+	const CachedPose &pose = getCachedPose(markerIndex);
 	
 	// Translation
-	translation.set(m34[0][3], m34[1][3], m34[2][3]);
+	translation.set(pose.trans[0][3], pose.trans[1][3], pose.trans[2][3]);
 	
 	// Orientation
-	orientation.set(m34[0][0], m34[0][1], m34[0][2], 0,
-					m34[1][0], m34[1][1], m34[1][2], 0,
-					m34[2][0], m34[2][1], m34[2][2], 0,
+	orientation.set(pose.trans[0][0], pose.trans[0][1], pose.trans[0][2], 0,
+					pose.trans[1][0], pose.trans[1][1], pose.trans[1][2], 0,
+					pose.trans[2][0], pose.trans[2][1], pose.trans[2][2], 0,
 					0, 0, 0, 1);
 }
 
+int ofxARToolkitPlus::computeAllPoses(MarkerPose *out, int maxPoses) {
+	solveAllPoses();
+	int numDetected = std::min(tracker->getNumDetectedMarkers(), maxPoses);
+	for(int i=0; i<numDetected; i++) {
+		const CachedPose &pose = getCachedPose(i);
+		MarkerPose &dst = out[i];
+		dst.id = tracker->getDetectedMarker(i).id;
+		memcpy(dst.matrix, pose.trans, sizeof(dst.matrix));
+		convertToGLMatrix(pose.trans, dst.glMatrix);
+		dst.error = pose.error;
+		dst.estimator = pose.estimator;
+	}
+	return numDetected;
+}
+
+int ofxARToolkitPlus::computeAllPoses(vector<MarkerPose> &out) {
+	int numDetected = tracker->getNumDetectedMarkers();
+	if(numDetected == 0) {
+		return 0;
+	}
+	if((int)out.size() < numDetected) {
+		out.resize(numDetected);
+	}
+	return computeAllPoses(&out[0], numDetected);
+}
+
 ofVec3f ofxARToolkitPlus::getCameraPosition(int markerIndex)  {
 
 	// Translation
@@ -336,47 +621,100 @@ ofVec3f ofxARToolkitPlus::getCameraPosition(int markerIndex)  {
 
 void ofxARToolkitPlus::getMultiMarkerTranslationAndOrientation(ofVec3f &translation, ofMatrix4x4 &orientation) {
 
-	const ARToolKitPlus::ARMultiMarkerInfoT *multiMarkerConst = tracker->getMultiMarkerConfig();
-	if(multiMarkerConst != NULL) {
-		// Create a copy of the ARMultiMarkerInfoT struct
-		ARToolKitPlus::ARMultiMarkerInfoT mm;
-		size_t mmSize = sizeof(ARToolKitPlus::ARMultiMarkerInfoT);
-		memcpy(&mm, multiMarkerConst, mmSize);
-		
-		// Copy and pass in the markers
-		int numberOfMarkers = tracker->getNumDetectedMarkers();
-#ifdef TARGET_WIN32
-		ARToolKitPlus::ARMarkerInfo *marker = new ARToolKitPlus::ARMarkerInfo[numberOfMarkers];
-#else
-		ARToolKitPlus::ARMarkerInfo marker[numberOfMarkers];
-#endif
-		for (int i=0; i<numberOfMarkers; i++) {
-			marker[i] = tracker->getDetectedMarker(i);
-		}
-		float result = tracker->rppMultiGetTransMat(marker, numberOfMarkers, &mm);
-		
-		// Check for error - yes this does occur
-		if(result < 0 || result >= INT_MAX) {
-			tracker->arMultiGetTransMat(marker, numberOfMarkers, &mm);
-			ofLog(OF_LOG_VERBOSE, "RPP failed on multimarker");	
-		} 
-		
-		// Translation
-		translation.set(mm.trans[0][3], mm.trans[1][3], mm.trans[2][3]);		
-		// Orientation
-		orientation.set(mm.trans[0][0], mm.trans[0][1], mm.trans[0][2], 0,
-						mm.trans[1][0], mm.trans[1][1], mm.trans[1][2], 0,
-						mm.trans[2][0], mm.trans[2][1], mm.trans[2][2], 0,
-						0, 0, 0, 1);
-#ifdef TARGET_WIN32
-		free(marker);
-#endif
-	} else {
+	if(!solveMultiMarkerPose()) {
 		ofLog(OF_LOG_VERBOSE, "MultiMarkerConfig file NULL");
+		return;
 	}
+	
+	const float (*trans)[4] = multiMarkerTrans;
+	// Translation
+	translation.set(trans[0][3], trans[1][3], trans[2][3]);		
+	// Orientation
+	orientation.set(trans[0][0], trans[0][1], trans[0][2], 0,
+					trans[1][0], trans[1][1], trans[1][2], 0,
+					trans[2][0], trans[2][1], trans[2][2], 0,
+					0, 0, 0, 1);
 
 }
 
+bool ofxARToolkitPlus::solveMultiMarkerPose() {
+	
+	if(multiMarkerPoseValid) {
+		return true;
+	}
+	
+	// calc() has solved the tracker's own board already
+	if(!multiMarkerLoaded) {
+		if(tracker->getMultiMarkerConfig() == NULL) {
+			return false;
+		}
+		tracker->getARMatrix(multiMarkerTrans);
+		multiMarkerPoseValid = true;
+		return true;
+	}
+	
+	// Our own copy of the loaded board, made once per board. It also carries
+	// the previous pose over to the next frame for arMultiGetTransMat.
+	const ARToolKitPlus::ARMultiMarkerInfoT *config = multiMarker;
+	if(config != multiMarkerPoseConfig) {
+		multiMarkerPose = *config;
+		multiMarkerPoseMarkers.assign(config->marker, config->marker + config->marker_num);
+		multiMarkerPose.marker = multiMarkerPoseMarkers.data();
+		multiMarkerPoseConfig = config;
+	}
+	
+	// The pose estimators take non-const markers, so hand them a copy.
+	// The buffer is reserved to maxImagePatterns in setup so this does not allocate.
+	int numberOfMarkers = tracker->getNumDetectedMarkers();
+	const ARToolKitPlus::ARMarkerInfo *detected = getDetectedMarkerInfos();
+	multiMarkerPoseInput.assign(detected, detected + numberOfMarkers);
+	ARToolKitPlus::ARMarkerInfo *marker = multiMarkerPoseInput.data();
+	
+	std::lock_guard<std::mutex> lock(ofxARToolkitPlusTracker::getLibraryMutex());
+	float result = tracker->rppMultiGetTransMat(marker, numberOfMarkers, &multiMarkerPose);
+	
+	// Check for error - yes this does occur
+	if(result < 0 || result >= INT_MAX) {
+		tracker->arMultiGetTransMat(marker, numberOfMarkers, &multiMarkerPose);
+		ofLog(OF_LOG_VERBOSE, "RPP failed on multimarker");	
+	}
+	
+	memcpy(multiMarkerTrans, multiMarkerPose.trans, sizeof(multiMarkerTrans));
+	multiMarkerPoseValid = true;
+	return true;
+}
+
+int ofxARToolkitPlus::getMultiMarkerNumVisible() {
+	const ARToolKitPlus::ARMultiMarkerInfoT *config = multiMarkerLoaded ? multiMarker : tracker->getMultiMarkerConfig();
+	if(config == NULL) {
+		return 0;
+	}
+	int numVisible = 0;
+	for(int i=0; i<config->marker_num; i++) {
+		int id = config->marker[i].patt_id;
+		if(id >= 0 && id <= MAX_MARKER_ID && markerIndexByID[id] >= 0) {
+			numVisible++;
+		}
+	}
+	return numVisible;
+}
+
+// Same markers at the same places
+static bool isSameBoard(const ARToolKitPlus::ARMultiMarkerInfoT &a, const ARToolKitPlus::ARMultiMarkerInfoT &b) {
+	if(a.marker_num != b.marker_num) {
+		return false;
+	}
+	for(int i=0; i<a.marker_num; i++) {
+		const ARToolKitPlus::ARMultiEachMarkerInfoT &ma = a.marker[i];
+		const ARToolKitPlus::ARMultiEachMarkerInfoT &mb = b.marker[i];
+		if(ma.patt_id != mb.patt_id || ma.width != mb.width || ma.center[0] != mb.center[0] || ma.center[1] != mb.center[1] ||
+			memcmp(ma.trans, mb.trans, sizeof(ma.trans)) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
 bool ofxARToolkitPlus::loadMultiMarkerFile(string filename) {
 
 	string fullFilePath = ofToDataPath(filename);
@@ -384,10 +722,19 @@ bool ofxARToolkitPlus::loadMultiMarkerFile(string filename) {
 		tracker->arMultiFreeConfig(multiMarker);		
 	}
 	multiMarker = tracker->arMultiReadConfigFile(fullFilePath.c_str());
+	// The next pose is solved from the new board
+	multiMarkerPoseConfig = NULL;
+	multiMarkerPoseValid = false;
 	
 	if(multiMarker==NULL) {
 		multiMarkerLoaded = false;
 		return false;
+	} else if(isSameBoard(*multiMarker, *tracker->getMultiMarkerConfig())) {
+		// calc() solves this board already, no need to solve it again
+		tracker->arMultiFreeConfig(multiMarker);
+		multiMarker = NULL;
+		multiMarkerLoaded = false;
+		return true;
 	} else {
 		multiMarkerLoaded = true;
 		return true;
@@ -406,10 +753,92 @@ void ofxARToolkitPlus::activateAutoThreshold(bool state) {
 	tracker->activateAutoThreshold(state);
 }
 
+void ofxARToolkitPlus::setAutoThresholdMethod(ofxARToolkitPlusTracker::AutoThresholdMethod method, bool aroundMarkers) {
+	tracker->setAutoThresholdMethod(method, aroundMarkers);
+}
+
+unsigned int ofxARToolkitPlus::getNumThresholdRetries() {
+	return tracker->getNumThresholdRetries();
+}
+
+void ofxARToolkitPlus::resetThresholdRetries() {
+	tracker->resetThresholdRetries();
+}
+
+void ofxARToolkitPlus::setDetectionROI(const ofRectangle &roi) {
+	detectionROIs.assign(1, roi);
+	tracker->setDetectionROIs(detectionROIs.data(), detectionROIs.size());
+}
+
+void ofxARToolkitPlus::setDetectionROIs(const vector<ofRectangle> &rois) {
+	detectionROIs = rois;
+	tracker->setDetectionROIs(detectionROIs.data(), detectionROIs.size());
+}
+
+void ofxARToolkitPlus::clearDetectionROI() {
+	detectionROIs.clear();
+	tracker->setDetectionROIs(NULL, 0);
+}
+
+const vector<ofRectangle>& ofxARToolkitPlus::getDetectionROIs() {
+	return detectionROIs;
+}
+
+void ofxARToolkitPlus::activatePredictiveROI(bool state, int fullScanInterval) {
+	tracker->activatePredictiveROI(state);
+	tracker->setFullScanInterval(fullScanInterval);
+}
+
+unsigned int ofxARToolkitPlus::getNumROIFrames() {
+	return tracker->getNumROIFrames();
+}
+
+unsigned int ofxARToolkitPlus::getNumFullScanFrames() {
+	return tracker->getNumFullScanFrames();
+}
+
+void ofxARToolkitPlus::resetScanCounters() {
+	tracker->resetScanCounters();
+}
+
+void ofxARToolkitPlus::setPyramidScale(int scale) {
+	tracker->setPyramidScale(scale);
+}
+
+void ofxARToolkitPlus::setHalfResolution(bool state) {
+	tracker->setImageProcessingMode(state ? ARToolKitPlus::IMAGE_HALF_RES : ARToolKitPlus::IMAGE_FULL_RES);
+}
+
+void ofxARToolkitPlus::activateCornerRefinement(bool state, int halfWindow) {
+	tracker->activateCornerRefinement(state, halfWindow);
+}
+
+unsigned long long ofxARToolkitPlus::getLastCornerRefineMicros() {
+	return tracker->getLastCornerRefineMicros();
+}
+
+void ofxARToolkitPlus::activateAdaptiveThreshold(bool state, int halfWindow, int offset) {
+	tracker->activateAdaptiveThreshold(state, halfWindow, offset);
+}
+
 void ofxARToolkitPlus::setMarkerWidth(float mm) {
 	markerWidth = mm;
 	halfMarkerWidth = markerWidth/2;
 	setupHomoSrc();
+	// Cached poses were solved for the old width
+	invalidatePoseCache();
+}
+
+void ofxARToolkitPlus::setNumLabelThreads(int numThreads) {
+	tracker->setNumLabelThreads(numThreads);
+}
+
+int ofxARToolkitPlus::getNumLabelThreads() {
+	return tracker->getNumLabelThreads();
+}
+
+unsigned long long ofxARToolkitPlus::getLastLabelMicros() {
+	return tracker->getLastLabelMicros();
 }
 
 void ofxARToolkitPlus::setupHomoSrc() {
@@ -428,14 +857,24 @@ int ofxARToolkitPlus::getNumDetectedMarkers() {
 }
 
 int ofxARToolkitPlus::getMarkerIndex(int markerID) {
-	int numDetected = tracker->getNumDetectedMarkers();
-	for(int i=0; i<numDetected; i++) {
-		ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(i);
-		if(marker.id == markerID) {
-			return i;
-		}
+	if(markerID < 0 || markerID > MAX_MARKER_ID) {
+		return -1;
+	}
+	return markerIndexByID[markerID];
+}
+
+void ofxARToolkitPlus::getMarkerIndices(const vector<int> &markerIDs, vector<int> &markerIndices) {
+	markerIndices.resize(markerIDs.size());
+	if(markerIDs.empty()) {
+		return;
+	}
+	getMarkerIndices(&markerIDs[0], markerIDs.size(), &markerIndices[0]);
+}
+
+void ofxARToolkitPlus::getMarkerIndices(const int *markerIDs, int numIDs, int *markerIndices) {
+	for(int i=0; i<numIDs; i++) {
+		markerIndices[i] = getMarkerIndex(markerIDs[i]);
 	}
-	return -1;
 }
 
 int ofxARToolkitPlus::getMarkerID(int markerIndex) {
@@ -443,13 +882,12 @@ int ofxARToolkitPlus::getMarkerID(int markerIndex) {
 	if (markerIndex < 0 || markerIndex >= numDetected) {
 		return -1;
 	}
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-	return marker.id;
+	return tracker->getDetectedMarker(markerIndex).id;
 }
 
 //--------------------------------------------------
 ofPoint ofxARToolkitPlus::getDetectedMarkerCenter(int markerIndex) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
+	const ARToolKitPlus::ARMarkerInfo &marker = tracker->getDetectedMarker(markerIndex);
 	return ofPoint(marker.pos[0], marker.pos[1]);
 }
 
@@ -458,36 +896,50 @@ int ofxARToolkitPlus::getDetectedMarkerDirection(int markerIndex) {
 }
 
 void ofxARToolkitPlus::getDetectedMarkerCorners(int markerIndex, vector<ofPoint> &corners) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-	corners.clear();
-	corners.push_back(ofPoint(marker.vertex[0][0], marker.vertex[0][1]));
-	corners.push_back(ofPoint(marker.vertex[1][0], marker.vertex[1][1]));
-	corners.push_back(ofPoint(marker.vertex[2][0], marker.vertex[2][1]));
-	corners.push_back(ofPoint(marker.vertex[3][0], marker.vertex[3][1]));
+	array<ofPoint, 4> fixedCorners;
+	getDetectedMarkerCorners(markerIndex, fixedCorners);
+	corners.assign(fixedCorners.begin(), fixedCorners.end());
 }
 
 void ofxARToolkitPlus::getDetectedMarkerOrderedCorners(int markerIndex, vector<ofPoint> &corners) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-	corners.clear();
-	
-	int index = 4 - marker.dir;
-	for (int i=0; i<4; i++) {		
-		corners.push_back(ofPoint(marker.vertex[index][0], marker.vertex[index][1]));
-		index++;
-		if(index >= 4) {
-			index = 0;
-		}
-	}	
+	array<ofPoint, 4> fixedCorners;
+	getDetectedMarkerOrderedCorners(markerIndex, fixedCorners);
+	corners.assign(fixedCorners.begin(), fixedCorners.end());
 }
 
 void ofxARToolkitPlus::getDetectedMarkerBorderCorners(int markerIndex, vector<ofPoint> &corners) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-	corners.clear();
-	corners.push_back(ofPoint(marker.vertex[0][0], marker.vertex[0][1]));
-	corners.push_back(ofPoint(marker.vertex[1][0], marker.vertex[1][1]));
-	corners.push_back(ofPoint(marker.vertex[2][0], marker.vertex[2][1]));
-	corners.push_back(ofPoint(marker.vertex[3][0], marker.vertex[3][1]));
+	array<ofPoint, 4> fixedCorners;
+	getDetectedMarkerBorderCorners(markerIndex, fixedCorners);
+	corners.assign(fixedCorners.begin(), fixedCorners.end());
+}
+
+void ofxARToolkitPlus::getDetectedMarkerOrderedBorderCorners(int markerIndex, vector<ofPoint> &corners) {
+	array<ofPoint, 4> fixedCorners;
+	getDetectedMarkerOrderedBorderCorners(markerIndex, fixedCorners);
+	corners.assign(fixedCorners.begin(), fixedCorners.end());
+}
+
+void ofxARToolkitPlus::getDetectedMarkerCorners(int markerIndex, array<ofPoint, 4> &corners) {
+	const ARToolKitPlus::ARMarkerInfo &marker = tracker->getDetectedMarker(markerIndex);
+	for (int i=0; i<4; i++) {
+		corners[i].set(marker.vertex[i][0], marker.vertex[i][1]);
+	}
+}
+
+void ofxARToolkitPlus::getDetectedMarkerOrderedCorners(int markerIndex, array<ofPoint, 4> &corners) {
+	const ARToolKitPlus::ARMarkerInfo &marker = tracker->getDetectedMarker(markerIndex);
+	
+	// Start at the corner the marker direction points to and go around from there
+	for (int i=0; i<4; i++) {
+		int index = (4 - marker.dir + i) % 4;
+		corners[i].set(marker.vertex[index][0], marker.vertex[index][1]);
+	}
+}
+
+void ofxARToolkitPlus::getDetectedMarkerBorderCorners(int markerIndex, array<ofPoint, 4> &corners) {
+	getDetectedMarkerCorners(markerIndex, corners);
 	
+	const ARToolKitPlus::ARMarkerInfo &marker = tracker->getDetectedMarker(markerIndex);
 	ofPoint center(marker.pos[0], marker.pos[1]);
 	for (int j=0; j<4; j++) {
 		corners[j] -= center;
@@ -496,19 +948,10 @@ void ofxARToolkitPlus::getDetectedMarkerBorderCorners(int markerIndex, vector<of
 	}
 }
 
-void ofxARToolkitPlus::getDetectedMarkerOrderedBorderCorners(int markerIndex, vector<ofPoint> &corners) {
-	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
-	corners.clear();
-	
-	int index = 4 - marker.dir;
-	for (int i=0; i<4; i++) {		
-		if(index >= 4) {
-			index = 0;
-		}		
-		corners.push_back(ofPoint(marker.vertex[index][0], marker.vertex[index][1]));
-		index++;
-	}
+void ofxARToolkitPlus::getDetectedMarkerOrderedBorderCorners(int markerIndex, array<ofPoint, 4> &corners) {
+	getDetectedMarkerOrderedCorners(markerIndex, corners);
 		
+	const ARToolKitPlus::ARMarkerInfo &marker = tracker->getDetectedMarker(markerIndex);
 	ofPoint center(marker.pos[0], marker.pos[1]);
 	for (int j=0; j<4; j++) {
 		corners[j] -= center;
@@ -517,14 +960,229 @@ void ofxARToolkitPlus::getDetectedMarkerOrderedBorderCorners(int markerIndex, ve
 	}
 }
 
-void ofxARToolkitPlus::getTransMat(ARToolKitPlus::ARMarkerInfo *marker_info, float center[2], float conv[3][4]) {
-	float result = tracker->rppGetTransMat( marker_info, center, markerWidth, conv );
+const ARToolKitPlus::ARMarkerInfo& ofxARToolkitPlus::getDetectedMarkerInfo(int markerIndex) {
+	return tracker->getDetectedMarker(markerIndex);
+}
+
+const ARToolKitPlus::ARMarkerInfo* ofxARToolkitPlus::getDetectedMarkerInfos() {
+	if(tracker->getNumDetectedMarkers() == 0) {
+		return NULL;
+	}
+	// The tracker keeps its detected markers in one array
+	return &tracker->getDetectedMarker(0);
+}
+
+float ofxARToolkitPlus::getTransMat(ARToolKitPlus::ARMarkerInfo *marker_info, float center[2], float conv[3][4], ARToolKitPlus::POSE_ESTIMATOR &estimator, bool &warmStarted) {
+	float result = rppGetTransMat( marker_info, center, conv, warmStarted );
+	estimator = ARToolKitPlus::POSE_ESTIMATOR_RPP;
 	
 	// Check for error - yes this does occur
 	if(result < 0 || result >= INT_MAX) {
 		ofLog(OF_LOG_VERBOSE, "RPP failed on marker " + ofToString(marker_info->id));	
 		// Use standard pose estimation
-		tracker->arGetTransMat( marker_info, center, markerWidth, conv );
+		result = tracker->arGetTransMat( marker_info, center, markerWidth, conv );
+		estimator = ARToolKitPlus::POSE_ESTIMATOR_ORIGINAL;
+	}
+	return result;
+}
+
+float ofxARToolkitPlus::rppGetTransMat(ARToolKitPlus::ARMarkerInfo *marker_info, float center[2], float conv[3][4], bool &warmStarted) {
+	warmStarted = false;
+	const PreviousPose *previous = warmStartPose ? getPreviousPose(marker_info->id) : NULL;
+	if(previous == NULL) {
+		std::lock_guard<std::mutex> lock(ofxARToolkitPlusTracker::getLibraryMutex());
+		return tracker->rppGetTransMat( marker_info, center, markerWidth, conv );
+	}
+	
+	// Same setup as Tracker::rppGetTransMat, but with the rotation
+	// of the previous frame instead of an estimated one
+	rpp_vec iprts[4];
+	rpp_vec model[4];
+	int dir = marker_info->dir;
+	for(int i=0; i<4; i++) {
+		int index = (4 + i - dir) % 4;
+		iprts[i][0] = marker_info->vertex[index][0];
+		iprts[i][1] = marker_info->vertex[index][1];
+		iprts[i][2] = 1;
+	}
+	model[0][0] = center[0] - halfMarkerWidth;	model[0][1] = center[1] + halfMarkerWidth;
+	model[1][0] = center[0] + halfMarkerWidth;	model[1][1] = center[1] + halfMarkerWidth;
+	model[2][0] = center[0] + halfMarkerWidth;	model[2][1] = center[1] - halfMarkerWidth;
+	model[3][0] = center[0] - halfMarkerWidth;	model[3][1] = center[1] - halfMarkerWidth;
+	for(int i=0; i<4; i++) {
+		model[i][2] = 0;
+	}
+	
+	const ARToolKitPlus::Camera *camera = tracker->getCamera();
+	const rpp_float cc[2] = { camera->mat[0][2], camera->mat[1][2] };
+	const rpp_float fc[2] = { camera->mat[0][0], camera->mat[1][1] };
+	
+	rpp_float err = 1e+20;
+	ofxARToolkitPlusMatrix<3, 3, rpp_float> R;
+	rpp_vec t;
+	{
+		std::lock_guard<std::mutex> lock(ofxARToolkitPlusTracker::getLibraryMutex());
+		robustPlanarPose(err, R.m, t, cc, fc, model, iprts, 4, previous->rotation.m, false, 0, 0, warmStartMaxIterations);
+		
+		// The marker moved too far for the old rotation to be a good start
+		if(err > warmStartMaxError * markerWidth) {
+			return tracker->rppGetTransMat( marker_info, center, markerWidth, conv );
+		}
+	}
+	
+	for(int i=0; i<3; i++) {
+		for(int j=0; j<3; j++) {
+			conv[i][j] = R(i, j);
+		}
+		conv[i][3] = t[i];
+	}
+	warmStarted = true;
+	return err;
+}
+
+void ofxARToolkitPlus::convertToGLMatrix(const float trans[3][4], float gl[16]) {
+	gl[0] = trans[0][0];
+	gl[1] = trans[1][0];	
+	gl[2] = trans[2][0];		
+	gl[3] = 0;			
+
+	gl[4] = trans[0][1];
+	gl[5] = trans[1][1];	
+	gl[6] = trans[2][1];		
+	gl[7] = 0;	
+
+	gl[8] = trans[0][2];
+	gl[9] = trans[1][2];	
+	gl[10] = trans[2][2];		
+	gl[11] = 0;	
+	
+	gl[12] = trans[0][3];
+	gl[13] = trans[1][3];	
+	gl[14] = trans[2][3];		
+	gl[15] = 1;	
+}
+
+//--------------------------------------------------
+const ofxARToolkitPlus::CachedPose& ofxARToolkitPlus::getCachedPose(int markerIndex) {
+	if(markerIndex < 0 || markerIndex >= tracker->getNumDetectedMarkers()) {
+		ofLog(OF_LOG_ERROR, "ofxARToolkitPlus: marker index " + ofToString(markerIndex) + " out of range, " + ofToString(tracker->getNumDetectedMarkers()) + " markers detected");
+		return invalidPose;
+	}
+	CachedPose &pose = poseCache[markerIndex];
+	if(pose.valid) {
+		poseCacheHits++;
+		return pose;
 	}
+	poseCacheMisses++;
+	// getTransMat takes a non-const marker so work on a copy
+	ARToolKitPlus::ARMarkerInfo marker = tracker->getDetectedMarker(markerIndex);
+	pose.error = getTransMat( &marker, c, pose.trans, pose.estimator, pose.warmStarted );
+	pose.valid = true;
+	countPoseStart(pose);
+	return pose;
 }
 
+void ofxARToolkitPlus::solveAllPoses() {
+	unsigned long long start = ofGetElapsedTimeMicros();
+	int numDetected = tracker->getNumDetectedMarkers();
+	
+	for(int i=0; i<numDetected; i++) {
+		getCachedPose(i);
+	}
+	lastPoseSolveMicros = ofGetElapsedTimeMicros() - start;
+}
+
+unsigned long long ofxARToolkitPlus::getLastPoseSolveMicros() {
+	return lastPoseSolveMicros;
+}
+
+unsigned long long ofxARToolkitPlus::getLastMultiMarkerPoseMicros() {
+	return tracker->getLastMultiMarkerPoseMicros();
+}
+
+void ofxARToolkitPlus::invalidatePoseCache() {
+	for(size_t i=0; i<poseCache.size(); i++) {
+		poseCache[i].valid = false;
+	}
+}
+
+unsigned int ofxARToolkitPlus::getPoseCacheHits() {
+	return poseCacheHits;
+}
+
+unsigned int ofxARToolkitPlus::getPoseCacheMisses() {
+	return poseCacheMisses;
+}
+
+void ofxARToolkitPlus::resetPoseCacheStats() {
+	poseCacheHits = 0;
+	poseCacheMisses = 0;
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlus::activateWarmStartPose(bool state) {
+	warmStartPose = state;
+	previousPoses.clear();
+}
+
+void ofxARToolkitPlus::setWarmStartMaxIterations(int iterations) {
+	// 0 would let RPP run until it converges
+	warmStartMaxIterations = std::max(iterations, 1);
+}
+
+void ofxARToolkitPlus::setWarmStartMaxError(float error) {
+	warmStartMaxError = error;
+}
+
+unsigned int ofxARToolkitPlus::getPoseWarmStarts() {
+	return poseWarmStarts;
+}
+
+unsigned int ofxARToolkitPlus::getPoseColdStarts() {
+	return poseColdStarts;
+}
+
+void ofxARToolkitPlus::resetPoseStartStats() {
+	poseWarmStarts = 0;
+	poseColdStarts = 0;
+}
+
+void ofxARToolkitPlus::keepPreviousPoses() {
+	if(!warmStartPose) {
+		return;
+	}
+	previousPoses.clear();
+	int numDetected = tracker->getNumDetectedMarkers();
+	for(int i=0; i<numDetected; i++) {
+		const CachedPose &pose = poseCache[i];
+		// Poses nobody asked for were never solved, and arGetTransMat poses are no good start for RPP
+		if(!pose.valid || pose.estimator != ARToolKitPlus::POSE_ESTIMATOR_RPP) {
+			continue;
+		}
+		PreviousPose previous;
+		previous.id = tracker->getDetectedMarker(i).id;
+		for(int r=0; r<3; r++) {
+			for(int c=0; c<3; c++) {
+				previous.rotation(r, c) = pose.trans[r][c];
+			}
+		}
+		previousPoses.push_back(previous);
+	}
+}
+
+const ofxARToolkitPlus::PreviousPose* ofxARToolkitPlus::getPreviousPose(int markerID) {
+	for(size_t i=0; i<previousPoses.size(); i++) {
+		if(previousPoses[i].id == markerID) {
+			return &previousPoses[i];
+		}
+	}
+	return NULL;
+}
+
+void ofxARToolkitPlus::countPoseStart(const CachedPose &pose) {
+	if(pose.warmStarted) {
+		poseWarmStarts++;
+	} else {
+		poseColdStarts++;
+	}
+}
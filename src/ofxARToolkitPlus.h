@@ -2,17 +2,64 @@
 
 #include "ofMain.h"
 #include <ar.h>
+#include <array>
 
-#include "ARToolKitPlus/TrackerMultiMarker.h"
+#include "ofxARToolkitPlusTracker.h"
+#include "ofxARToolkitPlusPixels.h"
 
 // Scale value for the border
 // Based on the type of marker
 #define BORDER_SCALE 1.25
 
+// Largest marker ID that can be detected (BCH markers go up to 4095)
+#define MAX_MARKER_ID 4095
+
 class ofxARToolkitPlus  {
 
 	public:	
 
+	/* Pose of a single detected marker as filled in by computeAllPoses() */
+	struct MarkerPose {
+		/* Marker ID */
+		int id;
+		/* ARTK 3x4 transformation matrix */
+		float matrix[ 3 ][ 4 ];
+		/* The same transformation in OpenGL order */
+		float glMatrix[ 16 ];
+		/* Error reported by the pose estimator */
+		float error;
+		/* POSE_ESTIMATOR_RPP, or POSE_ESTIMATOR_ORIGINAL if RPP failed and arGetTransMat was used */
+		ARToolKitPlus::POSE_ESTIMATOR estimator;
+	};
+
+	/* Layouts of the frames update() accepts. For the YUV formats only the Y samples are read */
+	enum InputFormat {
+		INPUT_GRAY,
+		INPUT_RGB,
+		INPUT_BGR,
+		INPUT_RGBA,
+		INPUT_BGRA,
+		INPUT_ABGR,
+		INPUT_RGB565,
+		/* Y plane followed by interleaved or separate chroma planes */
+		INPUT_NV12,
+		INPUT_I420,
+		/* Packed 4:2:2 */
+		INPUT_YUYV,
+		INPUT_UYVY
+	};
+
+	/* A frame as it comes from the camera */
+	struct InputImage {
+		InputImage(const unsigned char *pixels, InputFormat format, int stride = 0) : pixels(pixels), format(format), stride(stride) {}
+		/* First pixel (the start of the Y plane for NV12 and I420) */
+		const unsigned char *pixels;
+		InputFormat format;
+		/* Bytes from one row to the next (of the Y plane for NV12 and I420), 0 if the rows are tightly packed.
+		 * Frames with padding are repacked before tracking, see update(const InputImage&) */
+		int stride;
+	};
+
 	ofxARToolkitPlus();
 	~ofxARToolkitPlus();
 
@@ -50,6 +97,19 @@ class ofxARToolkitPlus  {
 	///////////////////////////////////////////
 	/* Find the marker and get back the confidence */
 	int update(unsigned char *pixels);
+	/* Same as above for a color image, which is converted to gray on the way in
+	 * so there is no need to convert it beforehand (e.g. with ofxOpenCv) */
+	int update(const unsigned char *pixels, ARToolKitPlus::PIXEL_FORMAT format);
+	/* Same as above for ofPixels in any of the formats InputFormat has, e.g. gray, RGB, BGRA or NV12 */
+	int update(ofPixels &pixels);
+	/* Same as above for a frame in any of the input formats, with or without row padding.
+	 * Gray, NV12 and I420 frames without padding are tracked in place, everything else
+	 * is converted to packed gray first. Padded gray rows are copied too: ARToolKitPlus
+	 * samples the marker patterns from rows exactly the frame width apart, so the labeling
+	 * and the adaptive threshold work on the same packed copy instead of the padded frame */
+	int update(const InputImage &image);
+	/* Find the markers only inside roi (in image pixels) for this frame, see setDetectionROI() */
+	int update(unsigned char *pixels, const ofRectangle &roi);
 	
 	///////////////////////////////////////////
 	// DRAW
@@ -60,6 +120,13 @@ class ofxARToolkitPlus  {
 	void draw(int x, int y);
 	/* Draw the marker center, outline, and id at the given position with the given size */
 	void draw(int x, int y, int width, int height);
+	/* Also draw the outer rectangle of the markers (the inner one scaled by BORDER_SCALE). Default is false */
+	void setDrawBorders(bool state);
+	/* Centers and outlines drawn by draw() as one mesh of colored lines in image coordinates.
+	 * Rebuilt on first use after update(), so it can be drawn or inspected without rebuilding */
+	const ofMesh& getOverlayMesh();
+	/* Fill mesh with the overlay lines of count markers. Needs no GL context */
+	static void buildOverlayMesh(const ARToolKitPlus::ARMarkerInfo *markers, int count, bool borders, ofMesh &mesh);
 	
 	///////////////////////////////////////////
 	// 3D GEOMETRY
@@ -80,7 +147,13 @@ class ofxARToolkitPlus  {
 	/* Get the homography matrix for the given marker based on the marker size */ 
 	ofMatrix4x4 getHomography(int markerIndex);
 	/* Get the homography matrix for the given marker based on four src corner points */ 
-	ofMatrix4x4 getHomography(int markerIndex, vector<ofPoint> &src);
+	ofMatrix4x4 getHomography(int markerIndex, const vector<ofPoint> &src);
+	/* Get the homography matrices of all detected markers (based on the marker size) in one pass.
+	 * Writes 16 floats per marker in OpenGL order, the same as getHomography(), into out.
+	 * At most maxMarkers matrices are written - returns the number of matrices written */
+	int getAllHomographies(float *out, int maxMarkers);
+	/* Same as above but based on four src corner points */
+	int getAllHomographies(const vector<ofPoint> &src, float *out, int maxMarkers);
 
 	/* Get the translation of the camera relative to the marker */
 	ofVec3f getTranslation(int markerIndex);
@@ -95,14 +168,59 @@ class ofxARToolkitPlus  {
 	 * Z Axis faces upwards from the marker */
 	ofVec3f getCameraPosition(int markerIndex);
 	
+	/* Poses are solved once per marker per update() and cached for the rest of the frame.
+	 * These counters tell how often an accessor was served from the cache (hit)
+	 * and how often it had to run the pose estimator (miss) */
+	unsigned int getPoseCacheHits();
+	unsigned int getPoseCacheMisses();
+	void resetPoseCacheStats();
+	
+	/* Solve the poses of all detected markers in one pass into a caller-owned array.
+	 * At most maxPoses entries are written - returns the number of poses written */
+	int computeAllPoses(MarkerPose *out, int maxPoses);
+	/* Same as above but fills a reusable vector, which only grows when more markers
+	 * are detected than it has room for. Entries past the returned count are stale */
+	int computeAllPoses(vector<MarkerPose> &out);
+	/* Solve the poses of all detected markers now instead of on first access.
+	 * RPP keeps its scratch matrices in statics of the prebuilt library, so the markers
+	 * are solved one after the other on the calling thread */
+	void solveAllPoses();
+	/* Time in microseconds the last solveAllPoses() call took */
+	unsigned long long getLastPoseSolveMicros();
+	/* Time in microseconds the last update() spent solving the multi-marker pose */
+	unsigned long long getLastMultiMarkerPoseMicros();
+	
+	/* Seed RPP with the rotation a marker ID had in the previous frame instead of
+	 * estimating it from scratch. Markers that were not solved in the previous frame,
+	 * or whose warm started pose has an error above the max error, are solved cold */
+	void activateWarmStartPose(bool state);
+	/* Iteration cap for warm started solves (cold solves run until they converge) */
+	void setWarmStartMaxIterations(int iterations);
+	/* Error above which a warm started pose is thrown away and solved cold. RPP's error grows
+	 * in proportion to the marker width, so this is given per mm of width. The default of 0.125
+	 * is about twice the worst error of cold solves on clean frames */
+	void setWarmStartMaxError(float error);
+	/* robustPlanarPose() only hands back the error, rotation and translation, and the library
+	 * is prebuilt, so the number of iterations it ran cannot be read out. These count solves instead.
+	 * Iterations spent are at most getPoseWarmStarts() * the warm start iteration cap
+	 * plus a full convergence for every cold start */
+	unsigned int getPoseWarmStarts();
+	unsigned int getPoseColdStarts();
+	void resetPoseStartStats();
+	
 	///////////////////////////////////////////
 	// MULTI MARKER
 	///////////////////////////////////////////
 	/* Get the translation of the multi-marker 
 	 * Details on how to create and load a mult-marker file:
-	 * http://www.hitl.washington.edu/artoolkit/documentation/tutorialmulti.htm */
+	 * http://www.hitl.washington.edu/artoolkit/documentation/tutorialmulti.htm
+	 * The pose of the board passed to setup() is the one calc() solves in update(), a board loaded with
+	 * loadMultiMarkerFile() is solved once per update(). Calling this again in the same frame is free */
 	void getMultiMarkerTranslationAndOrientation(ofVec3f &translation, ofMatrix4x4 &orientation);
-	/* Load a different multi-marker config file - returns true if it loaded (untested) */
+	/* Number of markers of the multi-marker detected in this frame, the pose is only valid if this is above 0 */
+	int getMultiMarkerNumVisible();
+	/* Load a different multi-marker config file, used from then on instead of the one passed to setup().
+	 * Returns true if it loaded */
 	bool loadMultiMarkerFile(string filename);
 	
 	///////////////////////////////////////////
@@ -112,8 +230,59 @@ class ofxARToolkitPlus  {
 	void setThreshold(int threshold);
 	/* Enables or disables automatic threshold calculation */
 	void activateAutoThreshold(bool state);
+	/* How automatic thresholding picks the threshold. The histogram methods take it from the
+	 * gray values of the image around the markers found, or of the whole image while there are none,
+	 * and search a frame without markers at most twice instead of retrying random thresholds */
+	void setAutoThresholdMethod(ofxARToolkitPlusTracker::AutoThresholdMethod method, bool aroundMarkers = true);
+	/* Number of detection passes repeated with another threshold since the last reset */
+	unsigned int getNumThresholdRetries();
+	void resetThresholdRetries();
+	/* Only look for markers inside the given rectangle(s) of the image from now on.
+	 * The detected markers are still in full image coordinates, but labeling, contours and
+	 * marker codes only read pixels inside the rectangles, so the work done scales with their area.
+	 * Markers that are not completely inside a rectangle are not found */
+	void setDetectionROI(const ofRectangle &roi);
+	void setDetectionROIs(const vector<ofRectangle> &rois);
+	/* Search the whole image again (the default) */
+	void clearDetectionROI();
+	const vector<ofRectangle>& getDetectionROIs();
+	/* Once markers are found, only search windows around where they are expected in the next frame.
+	 * The windows are predicted from the marker corners and their motion over the last frame.
+	 * Every fullScanInterval frames, and right after a marker was lost, the whole image
+	 * (or the detection ROIs) is searched again to pick up new markers */
+	void activatePredictiveROI(bool state, int fullScanInterval = 30);
+	/* Frames that only searched the predicted windows, and frames that did a full scan */
+	unsigned int getNumROIFrames();
+	unsigned int getNumFullScanFrames();
+	void resetScanCounters();
+	/* Search full scans coarse to fine: look for marker candidates in the image shrunk by
+	 * scale (2 or 4) first, then find the markers at full resolution in a small window
+	 * around each of them. Markers must be several times the scale wide to be found.
+	 * Default is 1, which searches the full resolution image directly */
+	void setPyramidScale(int scale);
+	/* Label every other pixel of every other row only (ARToolKitPlus' IMAGE_HALF_RES).
+	 * Labeling costs a quarter, the corners come from a contour of half the resolution */
+	void setHalfResolution(bool state);
+	/* Refine the marker corners to sub-pixel accuracy on the image gradients before the poses
+	 * are estimated. Each corner reads at most a few windows of 2 * halfWindow + 1 pixels square.
+	 * Brings the corners of half resolution labeling back to full resolution accuracy */
+	void activateCornerRefinement(bool state, int halfWindow = 4);
+	/* Time in microseconds the corner refinement of the last update() took */
+	unsigned long long getLastCornerRefineMicros();
+	/* Threshold every pixel against the mean brightness of the window of 2 * halfWindow + 1 pixels
+	 * around it: pixels more than offset darker than their surroundings are black. Finds the markers
+	 * all over a frame with uneven lighting in one pass, where the global threshold needs vignetting
+	 * compensation or auto threshold retries. Markers whose black border is much wider than halfWindow
+	 * pixels break up. Has no effect with setHalfResolution(true) */
+	void activateAdaptiveThreshold(bool state, int halfWindow = 32, int offset = 7);
 	/* Set the width of the markers to calculate an accurate matrix in real world scale */
 	void setMarkerWidth(float mm);
+	/* Set the number of threads labeling the image. Regions of more than 64 rows per thread are split
+	 * into horizontal stripes that are labeled at the same time. 1 (the default) labels on the calling thread */
+	void setNumLabelThreads(int numThreads);
+	int getNumLabelThreads();
+	/* Time in microseconds labeling took in the last update() */
+	unsigned long long getLastLabelMicros();
 
 	///////////////////////////////////////////
 	// MARKER INFO
@@ -122,6 +291,10 @@ class ofxARToolkitPlus  {
 	int getNumDetectedMarkers();
 	/* Get the index of the marker if found, else return -1 */
 	int getMarkerIndex(int markerID);
+	/* Look up the indices of several markers at once, -1 for markers that were not found.
+	 * markerIndices is resized to the number of IDs */
+	void getMarkerIndices(const vector<int> &markerIDs, vector<int> &markerIndices);
+	void getMarkerIndices(const int *markerIDs, int numIDs, int *markerIndices);
 	/* Get the marker ID of the given index - returns -1 if out of range */	
 	int getMarkerID(int markerIndex);
 	
@@ -144,124 +317,39 @@ class ofxARToolkitPlus  {
 	/* Adds the four corners of the detected marker border in screen coordinates to the passed in vector.
 	 * The corners are ordered consistantly, starting in the top left and going around in a clockwise direction. */
 	void getDetectedMarkerOrderedBorderCorners(int markerIndex, vector<ofPoint> &corners);
+	/* The same corner functions writing into a fixed size array, these never allocate */
+	void getDetectedMarkerCorners(int markerIndex, array<ofPoint, 4> &corners);
+	void getDetectedMarkerOrderedCorners(int markerIndex, array<ofPoint, 4> &corners);
+	void getDetectedMarkerBorderCorners(int markerIndex, array<ofPoint, 4> &corners);
+	void getDetectedMarkerOrderedBorderCorners(int markerIndex, array<ofPoint, 4> &corners);
+	
+	/* Read-only access to the raw detection data of a marker without copying it.
+	 * The reference stays valid until the next update() */
+	const ARToolKitPlus::ARMarkerInfo& getDetectedMarkerInfo(int markerIndex);
+	/* All detected markers as one contiguous array of getNumDetectedMarkers() entries,
+	 * or NULL if none were detected. The pointer stays valid until the next update() */
+	const ARToolKitPlus::ARMarkerInfo* getDetectedMarkerInfos();
 
 
 protected:
-	shared_ptr<ARToolKitPlus::TrackerMultiMarker> tracker;
-	/*
-	 * Homography Functions adapted from:
-	 * http://www.openframeworks.cc/forum/viewtopic.php?p=22611
-	 * Author: arturo castro
-	 */
-	void gaussian_elimination(float *input, int n){
-		// ported to c from pseudocode in
-		// http://en.wikipedia.org/wiki/Gaussian_elimination
-		
-		float * A = input;
-		int i = 0;
-		int j = 0;
-		int m = n-1;
-		while (i < m && j < n){
-			// Find pivot in column j, starting in row i:
-			int maxi = i;
-			for(int k = i+1; k<m; k++){
-				if(fabs(A[k*n+j]) > fabs(A[maxi*n+j])){
-					maxi = k;
-				}
-			}
-			if (A[maxi*n+j] != 0){
-				//swap rows i and maxi, but do not change the value of i
-				if(i!=maxi)
-					for(int k=0;k<n;k++){
-						float aux = A[i*n+k];
-						A[i*n+k]=A[maxi*n+k];
-						A[maxi*n+k]=aux;
-					}
-				//Now A[i,j] will contain the old value of A[maxi,j].
-				//divide each entry in row i by A[i,j]
-				float A_ij=A[i*n+j];
-				for(int k=0;k<n;k++){
-					A[i*n+k]/=A_ij;
-				}
-				//Now A[i,j] will have the value 1.
-				for(int u = i+1; u< m; u++){
-					//subtract A[u,j] * row i from row u
-					float A_uj = A[u*n+j];
-					for(int k=0;k<n;k++){
-						A[u*n+k]-=A_uj*A[i*n+k];
-					}
-					//Now A[u,j] will be 0, since A[u,j] - A[i,j] * A[u,j] = A[u,j] - 1 * A[u,j] = 0.
-				}
-				
-				i++;
-			}
-			j++;
-		}
-		
-		//back substitution
-		for(int i=m-2;i>=0;i--){
-			for(int j=i+1;j<n-1;j++){
-				A[i*n+m]-=A[i*n+j]*A[j*n+m];
-				//A[i*n+j]=0;
-			}
-		}
-	}
-
-	void findHomography(vector<ofPoint> src, vector<ofPoint> dst, float homography[16]){
-		
-		// create the equation system to be solved
-		//
-		// from: Multiple View Geometry in Computer Vision 2ed
-		//       Hartley R. and Zisserman A.
-		//
-		// x' = xH
-		// where H is the homography: a 3 by 3 matrix
-		// that transformed to inhomogeneous coordinates for each point
-		// gives the following equations for each point:
-		//
-		// x' * (h31*x + h32*y + h33) = h11*x + h12*y + h13
-		// y' * (h31*x + h32*y + h33) = h21*x + h22*y + h23
-		//
-		// as the homography is scale independent we can let h33 be 1 (indeed any of the terms)
-		// so for 4 points we have 8 equations for 8 terms to solve: h11 - h32
-		// after ordering the terms it gives the following matrix
-		// that can be solved with gaussian elimination:
-		
-		float P[8][9]={
-			{-src[0].x, -src[0].y, -1,   0,   0,  0, src[0].x*dst[0].x, src[0].y*dst[0].x, -dst[0].x }, // h11
-			{  0,   0,  0, -src[0].x, -src[0].y, -1, src[0].x*dst[0].y, src[0].y*dst[0].y, -dst[0].y }, // h12
-			
-			{-src[1].x, -src[1].y, -1,   0,   0,  0, src[1].x*dst[1].x, src[1].y*dst[1].x, -dst[1].x }, // h13
-			{  0,   0,  0, -src[1].x, -src[1].y, -1, src[1].x*dst[1].y, src[1].y*dst[1].y, -dst[1].y }, // h21
-			
-			{-src[2].x, -src[2].y, -1,   0,   0,  0, src[2].x*dst[2].x, src[2].y*dst[2].x, -dst[2].x }, // h22
-			{  0,   0,  0, -src[2].x, -src[2].y, -1, src[2].x*dst[2].y, src[2].y*dst[2].y, -dst[2].y }, // h23
-			
-			{-src[3].x, -src[3].y, -1,   0,   0,  0, src[3].x*dst[3].x, src[3].y*dst[3].x, -dst[3].x }, // h31
-			{  0,   0,  0, -src[3].x, -src[3].y, -1, src[3].x*dst[3].y, src[3].y*dst[3].y, -dst[3].y }, // h32
-		};
-		
-		gaussian_elimination(&P[0][0],9);
-		
-		// gaussian elimination gives the results of the equation system
-		// in the last column of the original matrix.
-		// opengl needs the transposed 4x4 matrix:
-		float aux_H[]={ P[0][8],P[3][8],0,P[6][8],	// h11  h21 0 h31
-						P[1][8],P[4][8],0,P[7][8],	// h12  h22 0 h32
-						0      ,      0,0,0,		// 0    0   0 0
-						P[2][8],P[5][8],0,1};		// h13  h23 0 h33
-		
-		for(int i=0;i<16;i++) homography[i] = aux_H[i];
-	}
+	shared_ptr<ofxARToolkitPlusTracker> tracker;
+	/* Closed form homographies for four point correspondences. Each homography is the unit
+	 * square to marker mapping composed with the inverse of the unit square to src mapping.
+	 * Maps src[i] to the i-th ordered border corner of each of the count markers and
+	 * writes 16 floats per marker in OpenGL order into out */
+	void computeHomographies(const ofPoint src[4], const ARToolKitPlus::ARMarkerInfo *markers, int count, float *out);
+	/* Projective mapping of the unit square (0,0) (1,0) (1,1) (0,1) onto the quad x, y.
+	 * H is row major with H[8] = 1 */
+	static void squareToQuad(const float x[4], const float y[4], float H[9]);
 
-	ofMatrix4x4 findHomography(vector<ofPoint> src, vector<ofPoint> dst){
-		float homography[16];
-		findHomography(src, dst, homography);
-		return ofMatrix4x4(homography);
-	}
-
-	/* Get the transpose matrix, first trying RPP then with standard functions if necessary */
-	void getTransMat(ARToolKitPlus::ARMarkerInfo *marker_info, float center[2], float conv[3][4]);
+	/* Get the transpose matrix, first trying RPP then with standard functions if necessary.
+	 * Returns the error of the pose and sets the estimator that produced it and whether RPP was warm started */
+	float getTransMat(ARToolKitPlus::ARMarkerInfo *marker_info, float center[2], float conv[3][4], ARToolKitPlus::POSE_ESTIMATOR &estimator, bool &warmStarted);
+	/* Run RPP on the marker, warm started if the marker was solved in the previous frame.
+	 * Holds the library lock while in RPP, whose scratch is shared by all trackers */
+	float rppGetTransMat(ARToolKitPlus::ARMarkerInfo *marker_info, float center[2], float conv[3][4], bool &warmStarted);
+	/* Convert an ARTK 3x4 matrix to an OpenGL 4x4 matrix */
+	void convertToGLMatrix(const float trans[3][4], float gl[16]);
 	
 	int width, height;
 	bool useBCH;
@@ -273,13 +361,91 @@ protected:
 	/* Setup the homography source */
 	void setupHomoSrc();
 	
+	/* Pose of a detected marker, filled lazily on first access after update() */
+	struct CachedPose {
+		float trans[ 3 ][ 4 ];
+		float error;
+		ARToolKitPlus::POSE_ESTIMATOR estimator;
+		bool warmStarted;
+		bool valid;
+	};
+	/* One entry per marker index, sized to maxImagePatterns */
+	vector<CachedPose> poseCache;
+	unsigned int poseCacheHits;
+	unsigned int poseCacheMisses;
+	/* Pose returned for marker indices out of range */
+	CachedPose invalidPose;
+	/* Return the pose of the marker, solving it only if this frame has not done so yet.
+	 * Logs an error and returns invalidPose if the index is not a detected marker */
+	const CachedPose& getCachedPose(int markerIndex);
+	/* Mark every cached pose as stale */
+	void invalidatePoseCache();
+	unsigned long long lastPoseSolveMicros;
+	
+	/* Rotation of the previous frame's RPP pose of a marker ID, kept in RPP's precision
+	 * as the start of the next solve */
+	struct PreviousPose {
+		int id;
+		ofxARToolkitPlusMatrix<3, 3, double> rotation;
+	};
+	/* Reserved to maxImagePatterns so keeping them does not allocate */
+	vector<PreviousPose> previousPoses;
+	bool warmStartPose;
+	int warmStartMaxIterations;
+	float warmStartMaxError;
+	unsigned int poseWarmStarts;
+	unsigned int poseColdStarts;
+	/* Keep the RPP poses solved for the current frame before update() replaces it */
+	void keepPreviousPoses();
+	/* Return the pose the marker ID had in the previous frame or NULL */
+	const PreviousPose* getPreviousPose(int markerID);
+	/* Count warm and cold starts of a freshly solved pose */
+	void countPoseStart(const CachedPose &pose);
+	
 	/* Matrix storage */
-	float m34[ 3 ][ 4 ];
 	float c[ 2 ];
 	float m[ 16 ]; 
 	
+	/* Multi-marker pose of this frame. calc() solves the tracker's own board already, update()
+	 * reads that pose. A board loaded with loadMultiMarkerFile() is solved on first access instead,
+	 * on multiMarkerPose, a copy of it made once per board with its markers pointing into multiMarkerPoseMarkers */
+	float multiMarkerTrans[ 3 ][ 4 ];
+	ARToolKitPlus::ARMultiMarkerInfoT multiMarkerPose;
+	vector<ARToolKitPlus::ARMultiEachMarkerInfoT> multiMarkerPoseMarkers;
+	/* Board config multiMarkerPose was copied from */
+	const ARToolKitPlus::ARMultiMarkerInfoT *multiMarkerPoseConfig;
+	/* Detected markers handed to the pose estimators */
+	vector<ARToolKitPlus::ARMarkerInfo> multiMarkerPoseInput;
+	bool multiMarkerPoseValid;
+	/* Read or solve the multi-marker pose unless this frame already did - returns false if there is no board config */
+	bool solveMultiMarkerPose();
+	
+	/* Rectangles set with setDetectionROI(s), restored after a single frame update() with a roi */
+	vector<ofRectangle> detectionROIs;
+	
+	/* Color frames converted to gray for the tracker */
+	vector<unsigned char> grayPixels;
+	/* Track a packed gray frame */
+	int track(const unsigned char *pixels);
+	/* Gray version of the frame, either the frame itself or converted into grayPixels */
+	const unsigned char* getGrayPixels(const InputImage &image);
+	
+	/* Debug overlay drawn by draw(), see getOverlayMesh() */
+	ofMesh overlayMesh;
+	bool overlayDirty;
+	bool drawBorders;
+	
+	/* Index of every detected marker by ID (-1 if not detected), rebuilt by update() */
+	vector<int> markerIndexByID;
+	/* Point markerIndexByID at the markers of the new frame */
+	void indexDetectedMarkers();
+	/* IDs set in markerIndexByID, so only those have to be cleared next frame */
+	vector<int> indexedMarkerIDs;
+	
 	/* If a multi-marker config file has been loaded after initialization */
 	bool multiMarkerLoaded;
+	/* The config loaded by loadMultiMarkerFile(), owned by this instance */
+	ARToolKitPlus::ARMultiMarkerInfoT *multiMarker;
 	
 };
 
@@ -0,0 +1,223 @@
+#include "ofxARToolkitPlusAsync.h"
+
+
+ofxARToolkitPlusAsync::ofxARToolkitPlusAsync() {
+	width = 0;
+	height = 0;
+	queueSize = 1;
+	frameNumber = 0;
+	running = false;
+	submittedFrames = 0;
+	trackedFrames = 0;
+	droppedFrames = 0;
+}
+
+ofxARToolkitPlusAsync::~ofxARToolkitPlusAsync() {
+	stop();
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusAsync::setup(int w, int h) {
+	// load std. ARToolKit camera file	
+	// These need to be in the data folder
+	setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusAsync::setup(int w, int h, string camParamFile, string multiFile, int maxImagePatterns, int pattWidth, int pattHeight, int pattSamples, int maxLoadPatterns) {
+	
+	stop();
+	
+	width = w;
+	height = h;
+	tracker.setup(w, h, camParamFile, multiFile, maxImagePatterns, pattWidth, pattHeight, pattSamples, maxLoadPatterns);
+	
+	// One frame for every queue place, one being copied in by update() and one being tracked
+	frames.resize(queueSize + 2);
+	freeFrames.clear();
+	pendingFrames.clear();
+	for(size_t i=0; i<frames.size(); i++) {
+		frames[i].pixels.resize(w * h);
+		freeFrames.push_back(i);
+	}
+	
+	// Size the results up front so publishing a frame does not allocate
+	for(int i=0; i<3; i++) {
+		Result &result = results[i];
+		result.frame = 0;
+		result.confidence = 0;
+		result.multiMarkerNumVisible = 0;
+		result.markers.reserve(maxImagePatterns);
+		result.markers.clear();
+		result.poses.reserve(maxImagePatterns);
+		result.poses.clear();
+		result.queueMicros = 0;
+		result.latencyMicros = 0;
+	}
+	
+	running = true;
+	thread = std::thread(&ofxARToolkitPlusAsync::threadedFunction, this);
+}
+
+void ofxARToolkitPlusAsync::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	wake.notify_all();
+	if(thread.joinable()) {
+		thread.join();
+	}
+}
+
+void ofxARToolkitPlusAsync::configure(const std::function<void(ofxARToolkitPlus&)> &function) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pendingConfigure.push_back(function);
+	}
+	wake.notify_one();
+}
+
+void ofxARToolkitPlusAsync::setQueueSize(int size) {
+	// The frames are sized for the queue in setup() and the tracking thread holds on to them
+	if(thread.joinable()) {
+		ofLog(OF_LOG_ERROR, "ofxARToolkitPlusAsync: call setQueueSize() before setup() or after stop()");
+		return;
+	}
+	queueSize = std::max(size, 1);
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusAsync::update(const unsigned char *pixels) {
+	
+	if(!thread.joinable()) {
+		ofLog(OF_LOG_ERROR, "ofxARToolkitPlusAsync: call setup() before update()");
+		return;
+	}
+	
+	// There is always a free frame: at most queueSize are pending and one is being tracked
+	int slot;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		slot = freeFrames.back();
+		freeFrames.pop_back();
+	}
+	
+	Frame &frame = frames[slot];
+	memcpy(&frame.pixels[0], pixels, frame.pixels.size());
+	frame.submitMicros = ofGetElapsedTimeMicros();
+	
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		frame.frame = ++frameNumber;
+		if((int)pendingFrames.size() >= queueSize) {
+			freeFrames.push_back(pendingFrames.front());
+			pendingFrames.pop_front();
+			droppedFrames++;
+		}
+		pendingFrames.push_back(slot);
+	}
+	submittedFrames++;
+	wake.notify_one();
+}
+
+bool ofxARToolkitPlusAsync::isFrameNew() {
+	return results.acquire();
+}
+
+const ofxARToolkitPlusAsync::Result& ofxARToolkitPlusAsync::getResult() {
+	results.acquire();
+	return results.getReadBuffer();
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusAsync::threadedFunction() {
+	vector<std::function<void(ofxARToolkitPlus&)> > configureNow;
+	while(true) {
+		int slot = -1;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] { return !running || !pendingFrames.empty() || !pendingConfigure.empty(); });
+			if(!running) {
+				return;
+			}
+			configureNow.swap(pendingConfigure);
+			if(!pendingFrames.empty()) {
+				slot = pendingFrames.front();
+				pendingFrames.pop_front();
+			}
+		}
+		
+		for(size_t i=0; i<configureNow.size(); i++) {
+			configureNow[i](tracker);
+		}
+		configureNow.clear();
+		
+		if(slot >= 0) {
+			track(slot);
+			std::lock_guard<std::mutex> lock(mutex);
+			freeFrames.push_back(slot);
+		}
+	}
+}
+
+void ofxARToolkitPlusAsync::track(int slot) {
+	
+	Frame &frame = frames[slot];
+	Result &result = results.getWriteBuffer();
+	
+	result.frame = frame.frame;
+	result.queueMicros = ofGetElapsedTimeMicros() - frame.submitMicros;
+	result.confidence = tracker.update(&frame.pixels[0]);
+	
+	int numDetected = tracker.getNumDetectedMarkers();
+	const ARToolKitPlus::ARMarkerInfo *markers = tracker.getDetectedMarkerInfos();
+	result.markers.assign(markers, markers + numDetected);
+	
+	// Shrinking keeps the capacity reserved in setup
+	result.poses.resize(numDetected);
+	if(numDetected > 0) {
+		tracker.computeAllPoses(&result.poses[0], numDetected);
+	}
+	
+	// The buffer still holds an older frame, nothing of it may be left over
+	result.multiMarkerNumVisible = tracker.getMultiMarkerNumVisible();
+	result.multiMarkerTranslation.set(0, 0, 0);
+	result.multiMarkerOrientation.makeIdentityMatrix();
+	if(result.multiMarkerNumVisible > 0) {
+		tracker.getMultiMarkerTranslationAndOrientation(result.multiMarkerTranslation, result.multiMarkerOrientation);
+	}
+	
+	result.latencyMicros = ofGetElapsedTimeMicros() - frame.submitMicros;
+	// Counted first, so a reader that sees the frame also sees it counted
+	trackedFrames++;
+	results.publish();
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusAsync::applyProjectionMatrix() {
+	tracker.applyProjectionMatrix();
+}
+
+void ofxARToolkitPlusAsync::applyProjectionMatrix(int viewportWidth, int viewportHeight) {
+	tracker.applyProjectionMatrix(viewportWidth, viewportHeight);
+}
+
+//--------------------------------------------------
+unsigned long long ofxARToolkitPlusAsync::getNumSubmittedFrames() {
+	return submittedFrames;
+}
+
+unsigned long long ofxARToolkitPlusAsync::getNumTrackedFrames() {
+	return trackedFrames;
+}
+
+unsigned long long ofxARToolkitPlusAsync::getNumDroppedFrames() {
+	return droppedFrames;
+}
+
+void ofxARToolkitPlusAsync::resetFrameCounters() {
+	submittedFrames = 0;
+	trackedFrames = 0;
+	droppedFrames = 0;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "ofxARToolkitPlus.h"
+#include "ofxARToolkitPlusTripleBuffer.h"
+
+#include <deque>
+
+/*
+ * Runs ofxARToolkitPlus on its own thread so the app thread never waits for detection.
+ * update() copies the frame into a small ring of pending frames and returns straight away.
+ * The worker detects the markers and solves their poses, then publishes the complete
+ * result of the frame, which getResult() picks up without blocking.
+ * If frames come in faster than they are tracked, the oldest pending frame is dropped.
+ */
+class ofxARToolkitPlusAsync {
+
+	public:
+
+	/* Everything tracked in one frame */
+	struct Result {
+		/* Number of the frame, counting the update() calls from 1. 0 until the first frame is tracked */
+		unsigned long long frame;
+		/* Value returned by ofxARToolkitPlus::update() */
+		int confidence;
+		/* Detected markers, in the same order as poses */
+		vector<ARToolKitPlus::ARMarkerInfo> markers;
+		/* Pose of every detected marker */
+		vector<ofxARToolkitPlus::MarkerPose> poses;
+		/* Number of multi-marker markers detected in the frame */
+		int multiMarkerNumVisible;
+		/* Multi-marker pose, only valid if multiMarkerNumVisible is above 0. Zero and identity otherwise */
+		ofVec3f multiMarkerTranslation;
+		ofMatrix4x4 multiMarkerOrientation;
+		/* Time in microseconds the frame waited in the queue, and from update() until it was published */
+		unsigned long long queueMicros;
+		unsigned long long latencyMicros;
+	};
+
+	ofxARToolkitPlusAsync();
+	~ofxARToolkitPlusAsync();
+
+	///////////////////////////////////////////
+	// SETUP
+	///////////////////////////////////////////
+	/* Same as ofxARToolkitPlus::setup(), and starts the tracking thread */
+	void setup(int w, int h);
+	void setup(int w, int h, string camParamFile, string multiFile, int maxImagePatterns = 8, int pattWidth = 6, int pattHeight = 6, int pattSamples = 6, int maxLoadPatterns = 0);
+	/* Stop the tracking thread. Frames still in the queue are thrown away */
+	void stop();
+
+	/* Change the tracker settings (threshold, marker width, label threads...).
+	 * The function is run on the tracking thread before the next frame */
+	void configure(const std::function<void(ofxARToolkitPlus&)> &function);
+	/* Number of frames that may wait to be tracked. Default is 1, which always tracks the newest frame.
+	 * Can only be changed while the thread is not running, before setup() or after stop() */
+	void setQueueSize(int size);
+
+	///////////////////////////////////////////
+	// UPDATE
+	///////////////////////////////////////////
+	/* Queue a copy of the frame for tracking and return without waiting for it */
+	void update(const unsigned char *pixels);
+	/* Pick up the newest tracked frame - returns true if one was tracked since the last pick up */
+	bool isFrameNew();
+	/* Newest tracked frame, picked up now if there is a newer one.
+	 * The result stays valid and unchanged until the next call to isFrameNew() or getResult() */
+	const Result& getResult();
+
+	///////////////////////////////////////////
+	// 3D GEOMETRY
+	///////////////////////////////////////////
+	/* See ofxARToolkitPlus. The projection does not change while tracking, so these are safe to call at any time */
+	void applyProjectionMatrix();
+	void applyProjectionMatrix(int viewportWidth, int viewportHeight);
+
+	///////////////////////////////////////////
+	// COUNTERS
+	///////////////////////////////////////////
+	/* Frames passed to update() */
+	unsigned long long getNumSubmittedFrames();
+	/* Frames tracked and published */
+	unsigned long long getNumTrackedFrames();
+	/* Frames dropped because the queue was full */
+	unsigned long long getNumDroppedFrames();
+	void resetFrameCounters();
+
+protected:
+	void threadedFunction();
+	/* Track the frame in the given slot into the write buffer and publish it */
+	void track(int slot);
+
+	ofxARToolkitPlus tracker;
+	int width, height;
+	int queueSize;
+
+	/* Frame ring: slots are either free, pending (waiting for the worker), being filled by update() or being tracked */
+	struct Frame {
+		vector<unsigned char> pixels;
+		unsigned long long frame;
+		unsigned long long submitMicros;
+	};
+	vector<Frame> frames;
+	vector<int> freeFrames;
+	std::deque<int> pendingFrames;
+	vector<std::function<void(ofxARToolkitPlus&)> > pendingConfigure;
+	/* Number of the last frame passed to update() */
+	unsigned long long frameNumber;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::thread thread;
+	bool running;
+
+	ofxARToolkitPlusTripleBuffer<Result> results;
+
+	std::atomic<unsigned long long> submittedFrames;
+	std::atomic<unsigned long long> trackedFrames;
+	std::atomic<unsigned long long> droppedFrames;
+
+};
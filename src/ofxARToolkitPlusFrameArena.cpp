@@ -0,0 +1,74 @@
+#include "ofxARToolkitPlusFrameArena.h"
+
+#include <stdlib.h>
+
+// Size of the first block, and of the smallest block added to a full one
+static const size_t minBlockSize = 64 * 1024;
+
+
+ofxARToolkitPlusFrameArena::ofxARToolkitPlusFrameArena() {
+	used = 0;
+	usedBefore = 0;
+	numBlockAllocations = 0;
+	// Room for the blocks of a few frames that grow before reset() merges them
+	blocks.reserve(16);
+}
+
+ofxARToolkitPlusFrameArena::~ofxARToolkitPlusFrameArena() {
+	for(size_t i=0; i<blocks.size(); i++) {
+		delete[] blocks[i].data;
+	}
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusFrameArena::reset() {
+	if(blocks.size() > 1) {
+		// The last frame did not fit, make room for all of it in one block
+		size_t capacity = getCapacity();
+		for(size_t i=0; i<blocks.size(); i++) {
+			delete[] blocks[i].data;
+		}
+		blocks.clear();
+		addBlock(capacity);
+	}
+	used = 0;
+	usedBefore = 0;
+}
+
+size_t ofxARToolkitPlusFrameArena::getNumBytesUsed() const {
+	return usedBefore + used;
+}
+
+size_t ofxARToolkitPlusFrameArena::getCapacity() const {
+	size_t capacity = 0;
+	for(size_t i=0; i<blocks.size(); i++) {
+		capacity += blocks[i].size;
+	}
+	return capacity;
+}
+
+unsigned int ofxARToolkitPlusFrameArena::getNumBlockAllocations() const {
+	return numBlockAllocations;
+}
+
+//--------------------------------------------------
+void* ofxARToolkitPlusFrameArena::allocBytes(size_t size, size_t alignment) {
+	if(!blocks.empty()) {
+		size_t start = (used + alignment - 1) & ~(alignment - 1);
+		if(start + size <= blocks.back().size) {
+			used = start + size;
+			return blocks.back().data + start;
+		}
+		usedBefore += used;
+	}
+	// Blocks come from new[], which aligns them for any type
+	addBlock(std::max(size, std::max(getCapacity(), minBlockSize)));
+	used = size;
+	return blocks.back().data;
+}
+
+void ofxARToolkitPlusFrameArena::addBlock(size_t size) {
+	Block block = { new uint8_t[size], size };
+	blocks.push_back(block);
+	numBlockAllocations++;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <stdint.h>
+
+/*
+ * Scratch memory for the temporaries of one frame. alloc() hands out memory
+ * by moving a pointer through a block, reset() takes all of it back at once.
+ * A frame that needs more than the block holds gets extra blocks, which reset()
+ * replaces with a single block big enough for all of them, so once the frames stop
+ * growing nothing is allocated from the heap any more.
+ */
+class ofxARToolkitPlusFrameArena {
+
+	public:
+
+	ofxARToolkitPlusFrameArena();
+	~ofxARToolkitPlusFrameArena();
+
+	/* Take back everything handed out since the last reset */
+	void reset();
+	/* Uninitialized room for count objects of a type that needs no constructor or destructor,
+	 * valid until the next reset() */
+	template<class T>
+	T* alloc(size_t count) {
+		return (T*)allocBytes(count * sizeof(T), alignof(T));
+	}
+
+	/* Bytes handed out since the last reset, and the size of all blocks */
+	size_t getNumBytesUsed() const;
+	size_t getCapacity() const;
+	/* Number of blocks allocated from the heap so far */
+	unsigned int getNumBlockAllocations() const;
+
+protected:
+	void* allocBytes(size_t size, size_t alignment);
+	void addBlock(size_t size);
+
+	/* The block being handed out is the last one */
+	struct Block {
+		uint8_t *data;
+		size_t size;
+	};
+	vector<Block> blocks;
+	/* Bytes used of the last block, and of the ones before it */
+	size_t used;
+	size_t usedBefore;
+	unsigned int numBlockAllocations;
+
+};
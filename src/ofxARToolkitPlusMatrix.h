@@ -0,0 +1,193 @@
+#pragma once
+
+#include "ARToolKitPlus/config.h"
+
+#include <cmath>
+#include <algorithm>
+
+/*
+ * A matrix of a size known at compile time, kept by value. ARToolKitPlus' ARMat is sized at
+ * run time and allocated on the heap, which is a lot of overhead for the 2x2 and 3x4 matrices
+ * of line fits, poses and homographies. With the size fixed, the loops below have constant bounds the compiler
+ * unrolls, and small matrices can stay in registers.
+ * The operations do the same arithmetic in the same order as their ARToolKitPlus counterparts,
+ * so they give the same results.
+ */
+template<int Rows, int Cols, class T = ARFloat>
+class ofxARToolkitPlusMatrix {
+
+	public:
+
+	static constexpr int rows = Rows;
+	static constexpr int cols = Cols;
+
+	static ofxARToolkitPlusMatrix zero() {
+		ofxARToolkitPlusMatrix result;
+		for(int r=0; r<Rows; r++) {
+			for(int c=0; c<Cols; c++) {
+				result.m[r][c] = 0;
+			}
+		}
+		return result;
+	}
+
+	/* Ones on the diagonal, also for matrices that are not square */
+	static ofxARToolkitPlusMatrix identity() {
+		ofxARToolkitPlusMatrix result = zero();
+		for(int i=0; i<Rows && i<Cols; i++) {
+			result.m[i][i] = 1;
+		}
+		return result;
+	}
+
+	T& operator()(int r, int c) {
+		return m[r][c];
+	}
+
+	const T& operator()(int r, int c) const {
+		return m[r][c];
+	}
+
+	/* Same as Matrix::mul */
+	template<int Cols2>
+	ofxARToolkitPlusMatrix<Rows, Cols2, T> operator*(const ofxARToolkitPlusMatrix<Cols, Cols2, T> &other) const {
+		ofxARToolkitPlusMatrix<Rows, Cols2, T> result;
+		for(int r=0; r<Rows; r++) {
+			for(int c=0; c<Cols2; c++) {
+				T sum = 0;
+				for(int k=0; k<Cols; k++) {
+					sum += m[r][k] * other.m[k][c];
+				}
+				result.m[r][c] = sum;
+			}
+		}
+		return result;
+	}
+
+	ofxARToolkitPlusMatrix<Cols, Rows, T> transposed() const {
+		ofxARToolkitPlusMatrix<Cols, Rows, T> result;
+		for(int r=0; r<Rows; r++) {
+			for(int c=0; c<Cols; c++) {
+				result.m[c][r] = m[r][c];
+			}
+		}
+		return result;
+	}
+
+	/* The inverse times the determinant of a 3x3 matrix, for when the scale does not matter */
+	ofxARToolkitPlusMatrix adjugate() const {
+		static_assert(Rows == 3 && Cols == 3, "only the adjugate of 3x3 matrices is written out");
+		ofxARToolkitPlusMatrix result = {{
+			{ m[1][1]*m[2][2] - m[1][2]*m[2][1], m[0][2]*m[2][1] - m[0][1]*m[2][2], m[0][1]*m[1][2] - m[0][2]*m[1][1] },
+			{ m[1][2]*m[2][0] - m[1][0]*m[2][2], m[0][0]*m[2][2] - m[0][2]*m[2][0], m[0][2]*m[1][0] - m[0][0]*m[1][2] },
+			{ m[1][0]*m[2][1] - m[1][1]*m[2][0], m[0][1]*m[2][0] - m[0][0]*m[2][1], m[0][0]*m[1][1] - m[0][1]*m[1][0] }
+		}};
+		return result;
+	}
+
+	/* Same as Matrix::selfInv: invert in place by Gauss-Jordan elimination with partial pivoting.
+	 * Returns false, leaving the matrix half done, if it is singular */
+	bool invert() {
+		static_assert(Rows == Cols, "only square matrices can be inverted");
+		if(Rows == 1) {
+			m[0][0] = 1 / m[0][0];
+			return true;
+		}
+		const T epsilon = (T)1.0e-10;
+		// Every step divides the pivot row by the pivot and moves all rows one column to the left,
+		// so the pivot column is always the first one. nos keeps track of the row swaps
+		int nos[Rows];
+		for(int n=0; n<Rows; n++) {
+			nos[n] = n;
+		}
+		for(int n=0; n<Rows; n++) {
+			T pivot = 0;
+			int ip = n;
+			for(int i=n; i<Rows; i++) {
+				T value = std::fabs(m[i][0]);
+				if(pivot < value) {
+					pivot = value;
+					ip = i;
+				}
+			}
+			if(pivot <= epsilon) {
+				return false;
+			}
+			std::swap(nos[ip], nos[n]);
+			for(int j=0; j<Cols; j++) {
+				std::swap(m[ip][j], m[n][j]);
+			}
+
+			T work = m[n][0];
+			for(int j=1; j<Cols; j++) {
+				m[n][j-1] = m[n][j] / work;
+			}
+			m[n][Cols-1] = 1 / work;
+			for(int i=0; i<Rows; i++) {
+				if(i != n) {
+					work = m[i][0];
+					for(int j=1; j<Cols; j++) {
+						m[i][j-1] = m[i][j] - work * m[n][j-1];
+					}
+					m[i][Cols-1] = -work * m[n][Cols-1];
+				}
+			}
+		}
+		// Undo the row swaps on the columns of the inverse
+		for(int n=0; n<Rows; n++) {
+			int j = n;
+			while(j < Rows && nos[j] != n) {
+				j++;
+			}
+			nos[j] = nos[n];
+			for(int i=0; i<Rows; i++) {
+				std::swap(m[i][j], m[i][n]);
+			}
+		}
+		return true;
+	}
+
+	T m[Rows][Cols];
+
+};
+
+/* A column vector */
+template<int Size, class T = ARFloat>
+using ofxARToolkitPlusVector = ofxARToolkitPlusMatrix<Size, 1, T>;
+
+/* A 3x4 pose [R|t], as ARToolKitPlus keeps them */
+template<class T = ARFloat>
+using ofxARToolkitPlusPose = ofxARToolkitPlusMatrix<3, 4, T>;
+
+/* Same as arUtilMatMul: the pose a applied after b, both read as 4x4 matrices with a last row of 0 0 0 1 */
+template<class T>
+ofxARToolkitPlusPose<T> ofxARToolkitPlusMulPose(const ofxARToolkitPlusPose<T> &a, const ofxARToolkitPlusPose<T> &b) {
+	ofxARToolkitPlusPose<T> result;
+	for(int r=0; r<3; r++) {
+		for(int c=0; c<4; c++) {
+			result.m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c] + a.m[r][2] * b.m[2][c];
+		}
+		result.m[r][3] += a.m[r][3];
+	}
+	return result;
+}
+
+/* Same as arUtilMatInv: the inverse of a pose read as a 4x4 matrix. Returns false if it is singular */
+template<class T>
+bool ofxARToolkitPlusInvertPose(const ofxARToolkitPlusPose<T> &pose, ofxARToolkitPlusPose<T> &inverse) {
+	ofxARToolkitPlusMatrix<4, 4, T> full = ofxARToolkitPlusMatrix<4, 4, T>::identity();
+	for(int r=0; r<3; r++) {
+		for(int c=0; c<4; c++) {
+			full.m[r][c] = pose.m[r][c];
+		}
+	}
+	if(!full.invert()) {
+		return false;
+	}
+	for(int r=0; r<3; r++) {
+		for(int c=0; c<4; c++) {
+			inverse.m[r][c] = full.m[r][c];
+		}
+	}
+	return true;
+}
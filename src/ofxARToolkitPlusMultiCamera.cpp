@@ -0,0 +1,198 @@
+#include "ofxARToolkitPlusMultiCamera.h"
+
+
+ofxARToolkitPlusMultiCamera::ofxARToolkitPlusMultiCamera() {
+	tick.tick = 0;
+	tick.timestamp = 0;
+	tick.skewMicros = 0;
+	tick.fusedCameras = 0;
+	solveMarkerPoses = true;
+	lastUpdateMicros = 0;
+}
+
+//--------------------------------------------------
+int ofxARToolkitPlusMultiCamera::addCamera(int w, int h, string camParamFile, string multiFile, int maxImagePatterns, int pattWidth, int pattHeight, int pattSamples, int maxLoadPatterns) {
+	
+	shared_ptr<ofxARToolkitPlus> camera = make_shared<ofxARToolkitPlus>();
+	camera->setup(w, h, camParamFile, multiFile, maxImagePatterns, pattWidth, pattHeight, pattSamples, maxLoadPatterns);
+	cameras.push_back(camera);
+	
+	CameraPose pose;
+	pose.hasPose = false;
+	cameraPoses.push_back(pose);
+	
+	CameraResult result;
+	result.timestamp = 0;
+	result.confidence = 0;
+	result.poses.reserve(maxImagePatterns);
+	result.boardMarkers = 0;
+	tick.cameras.push_back(result);
+	
+	return cameras.size() - 1;
+}
+
+int ofxARToolkitPlusMultiCamera::getNumCameras() {
+	return cameras.size();
+}
+
+ofxARToolkitPlus& ofxARToolkitPlusMultiCamera::getCamera(int camera) {
+	return *cameras[camera];
+}
+
+void ofxARToolkitPlusMultiCamera::setCameraPose(int camera, const ofMatrix4x4 &cameraToWorld) {
+	CameraPose &pose = cameraPoses[camera];
+	const float *m = cameraToWorld.getPtr();
+	for(int r=0; r<3; r++) {
+		for(int c=0; c<4; c++) {
+			pose.trans(r, c) = m[r*4 + c];
+		}
+	}
+	pose.hasPose = true;
+}
+
+void ofxARToolkitPlusMultiCamera::setNumThreads(int numThreads) {
+	pool.setup(std::max(numThreads, 1));
+}
+
+int ofxARToolkitPlusMultiCamera::getNumThreads() {
+	return pool.getNumThreads();
+}
+
+void ofxARToolkitPlusMultiCamera::setSolveMarkerPoses(bool state) {
+	solveMarkerPoses = state;
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusMultiCamera::update(unsigned char * const *pixels, const unsigned long long *timestamps) {
+	
+	unsigned long long start = ofGetElapsedTimeMicros();
+	int numCameras = cameras.size();
+	
+	unsigned long long earliest = timestamps != NULL && numCameras > 0 ? timestamps[0] : start;
+	unsigned long long latest = earliest;
+	for(int i=0; i<numCameras; i++) {
+		unsigned long long timestamp = timestamps != NULL ? timestamps[i] : start;
+		tick.cameras[i].timestamp = timestamp;
+		earliest = std::min(earliest, timestamp);
+		latest = std::max(latest, timestamp);
+	}
+	tick.tick++;
+	tick.timestamp = latest;
+	tick.skewMicros = latest - earliest;
+	
+	// Each camera only touches its own tracker and tick entry, the library statics are behind the library lock
+	pool.run(numCameras, [this, pixels](int i) {
+		updateCamera(i, pixels[i]);
+	});
+	
+	fuseBoard();
+	lastUpdateMicros = ofGetElapsedTimeMicros() - start;
+}
+
+void ofxARToolkitPlusMultiCamera::updateCamera(int camera, unsigned char *pixels) {
+	
+	ofxARToolkitPlus &tracker = *cameras[camera];
+	CameraResult &result = tick.cameras[camera];
+	
+	result.confidence = tracker.update(pixels);
+	
+	// Shrinking keeps the capacity reserved in addCamera
+	int numDetected = solveMarkerPoses ? tracker.getNumDetectedMarkers() : 0;
+	result.poses.resize(numDetected);
+	if(numDetected > 0) {
+		tracker.computeAllPoses(&result.poses[0], numDetected);
+	}
+	
+	result.boardMarkers = tracker.getMultiMarkerNumVisible();
+	if(result.boardMarkers > 0) {
+		ofVec3f translation;
+		ofMatrix4x4 orientation;
+		tracker.getMultiMarkerTranslationAndOrientation(translation, orientation);
+		const float *m = orientation.getPtr();
+		for(int r=0; r<3; r++) {
+			for(int c=0; c<3; c++) {
+				result.board[r][c] = m[r*4 + c];
+			}
+		}
+		result.board[0][3] = translation.x;
+		result.board[1][3] = translation.y;
+		result.board[2][3] = translation.z;
+	}
+}
+
+const ofxARToolkitPlusMultiCamera::Tick& ofxARToolkitPlusMultiCamera::getTick() {
+	return tick;
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusMultiCamera::fuseBoard() {
+	
+	// Average of the board poses in world coordinates, weighted by
+	// the number of board markers each camera saw
+	ofxARToolkitPlusPose<float> sum = ofxARToolkitPlusPose<float>::zero();
+	float totalWeight = 0;
+	tick.fusedCameras = 0;
+	
+	for(size_t i=0; i<cameras.size(); i++) {
+		const CameraResult &result = tick.cameras[i];
+		const CameraPose &pose = cameraPoses[i];
+		if(!pose.hasPose || result.boardMarkers == 0) {
+			continue;
+		}
+		
+		// Board to world = camera to world * board to camera
+		float weight = result.boardMarkers;
+		ofxARToolkitPlusPose<float> boardToCamera;
+		memcpy(boardToCamera.m, result.board, sizeof(boardToCamera.m));
+		ofxARToolkitPlusPose<float> boardToWorld = ofxARToolkitPlusMulPose(pose.trans, boardToCamera);
+		for(int r=0; r<3; r++) {
+			for(int c=0; c<4; c++) {
+				sum(r, c) += weight * boardToWorld(r, c);
+			}
+		}
+		totalWeight += weight;
+		tick.fusedCameras++;
+	}
+	
+	if(tick.fusedCameras == 0) {
+		return;
+	}
+	
+	float (*fused)[4] = tick.fusedBoard;
+	for(int r=0; r<3; r++) {
+		for(int c=0; c<4; c++) {
+			fused[r][c] = sum(r, c) / totalWeight;
+		}
+	}
+	
+	// The averaged rotation is no longer orthonormal, so rebuild it from its first two columns
+	ofVec3f x(fused[0][0], fused[1][0], fused[2][0]);
+	ofVec3f y(fused[0][1], fused[1][1], fused[2][1]);
+	x.normalize();
+	y -= x * x.dot(y);
+	y.normalize();
+	ofVec3f z = x.getCrossed(y);
+	for(int r=0; r<3; r++) {
+		fused[r][0] = x[r];
+		fused[r][1] = y[r];
+		fused[r][2] = z[r];
+	}
+}
+
+bool ofxARToolkitPlusMultiCamera::getFusedBoardTranslationAndOrientation(ofVec3f &translation, ofMatrix4x4 &orientation) {
+	if(tick.fusedCameras == 0) {
+		return false;
+	}
+	const float (*fused)[4] = tick.fusedBoard;
+	// Same layout as ofxARToolkitPlus::getMultiMarkerTranslationAndOrientation()
+	translation.set(fused[0][3], fused[1][3], fused[2][3]);
+	orientation.set(fused[0][0], fused[0][1], fused[0][2], 0,
+					fused[1][0], fused[1][1], fused[1][2], 0,
+					fused[2][0], fused[2][1], fused[2][2], 0,
+					0, 0, 0, 1);
+	return true;
+}
+
+unsigned long long ofxARToolkitPlusMultiCamera::getLastUpdateMicros() {
+	return lastUpdateMicros;
+}
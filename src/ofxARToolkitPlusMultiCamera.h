@@ -0,0 +1,110 @@
+#pragma once
+
+#include "ofxARToolkitPlus.h"
+#include "ofxARToolkitPlusWorkerPool.h"
+
+/*
+ * Tracks several cameras at once, one ofxARToolkitPlus per camera.
+ * update() hands the cameras out to a shared pool of threads and returns
+ * once all of them are done, so afterwards each camera can be read like a single tracker.
+ * Every update() is one tick: the per-camera results, their capture timestamps and,
+ * for cameras with a known pose, one board pose fused from all cameras that saw it.
+ *
+ * ARToolKitPlus keeps RPP's scratch matrices and the camera size in statics shared by all
+ * trackers, so the pose solves and the setups of all cameras take turns on the library lock
+ * (see ofxARToolkitPlusTracker::getLibraryMutex). Only the detection runs side by side, so
+ * ticks do not get much faster with more threads: with 4 cameras of 640x480 seeing the 20 markers
+ * of a board, the pose solves are 98% of a tick (66% with board poses only), which limits
+ * 4 cores to 1.0x (1.3x) the speed of one. testMultiCamera in the tests reports these numbers.
+ * Cameras of different sizes can be mixed.
+ */
+class ofxARToolkitPlusMultiCamera {
+
+	public:
+
+	/* What one camera saw in a tick */
+	struct CameraResult {
+		/* Capture timestamp of the frame in microseconds, as passed to update() */
+		unsigned long long timestamp;
+		/* Value returned by ofxARToolkitPlus::update() */
+		int confidence;
+		/* Pose of every detected marker, in camera coordinates. Empty if marker poses are not solved */
+		vector<ofxARToolkitPlus::MarkerPose> poses;
+		/* Multi-marker pose in camera coordinates, only valid if boardMarkers > 0 */
+		float board[ 3 ][ 4 ];
+		/* Number of multi-marker markers the board pose was solved from */
+		int boardMarkers;
+	};
+
+	/* Results of all cameras for one update() */
+	struct Tick {
+		/* Number of the tick, counting the update() calls from 1 */
+		unsigned long long tick;
+		/* Latest and earliest capture timestamp of the cameras */
+		unsigned long long timestamp;
+		unsigned long long skewMicros;
+		/* One entry per camera */
+		vector<CameraResult> cameras;
+		/* Board pose in world coordinates fused from all cameras with a pose that saw the board */
+		float fusedBoard[ 3 ][ 4 ];
+		/* Number of cameras fusedBoard was fused from, 0 if it is not valid */
+		int fusedCameras;
+	};
+
+	ofxARToolkitPlusMultiCamera();
+
+	///////////////////////////////////////////
+	// SETUP
+	///////////////////////////////////////////
+	/* Add a camera, set up like ofxARToolkitPlus::setup() - returns its index */
+	int addCamera(int w, int h, string camParamFile, string multiFile, int maxImagePatterns = 8, int pattWidth = 6, int pattHeight = 6, int pattSamples = 6, int maxLoadPatterns = 0);
+	int getNumCameras();
+	/* The tracker of a camera. Use it to change its settings or read its results between updates */
+	ofxARToolkitPlus& getCamera(int camera);
+
+	/* Set the pose of a camera in world coordinates (camera to world, ARTK order as getMatrix()).
+	 * Only cameras with a pose take part in the fused board pose */
+	void setCameraPose(int camera, const ofMatrix4x4 &cameraToWorld);
+	/* Total number of threads the cameras are tracked on (including the calling thread). Default is 1.
+	 * Only the detection overlaps, so the speedup is bounded by the share of time spent outside RPP */
+	void setNumThreads(int numThreads);
+	int getNumThreads();
+	/* Solve the pose of every detected marker into the camera results (the default), or only the board pose.
+	 * Marker poses are most of the work of a tick, and like the board pose they can not run in parallel */
+	void setSolveMarkerPoses(bool state);
+
+	///////////////////////////////////////////
+	// UPDATE
+	///////////////////////////////////////////
+	/* Track one frame from every camera - pixels and timestamps have one entry per camera.
+	 * Without timestamps the frames are stamped with the time of the call */
+	void update(unsigned char * const *pixels, const unsigned long long *timestamps = NULL);
+	/* Results of the last update() */
+	const Tick& getTick();
+
+	/* Get the fused board pose of the last update() - returns false if no camera with a pose saw the board */
+	bool getFusedBoardTranslationAndOrientation(ofVec3f &translation, ofMatrix4x4 &orientation);
+
+	/* Time in microseconds the last update() took */
+	unsigned long long getLastUpdateMicros();
+
+protected:
+	/* Track one camera into its tick entry, run on the pool */
+	void updateCamera(int camera, unsigned char *pixels);
+	/* Fuse the board poses of the tick into fusedBoard */
+	void fuseBoard();
+
+	vector<shared_ptr<ofxARToolkitPlus> > cameras;
+	/* Camera to world, with hasPose false for cameras that have not been given one */
+	struct CameraPose {
+		ofxARToolkitPlusPose<float> trans;
+		bool hasPose;
+	};
+	vector<CameraPose> cameraPoses;
+
+	ofxARToolkitPlusWorkerPool pool;
+	bool solveMarkerPoses;
+	Tick tick;
+	unsigned long long lastUpdateMicros;
+
+};
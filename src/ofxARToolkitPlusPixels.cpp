@@ -0,0 +1,590 @@
+#include "ofxARToolkitPlusPixels.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OFX_ARTKP_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define OFX_ARTKP_SSSE3
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define OFX_ARTKP_AVX2
+#include <immintrin.h>
+#endif
+
+// BT.601 weights of R, G and B in 1/256, summing to 256. OpenCV rounds the same weights
+// to 1/16384, so about one color in eight comes out one gray level apart
+#define GRAY_R 77
+#define GRAY_G 150
+#define GRAY_B 29
+
+
+int ofxARToolkitPlusGetBytesPerPixel(ARToolKitPlus::PIXEL_FORMAT format) {
+	switch(format) {
+		case ARToolKitPlus::PIXEL_FORMAT_ABGR:
+		case ARToolKitPlus::PIXEL_FORMAT_BGRA:
+		case ARToolKitPlus::PIXEL_FORMAT_RGBA:
+			return 4;
+		case ARToolKitPlus::PIXEL_FORMAT_BGR:
+		case ARToolKitPlus::PIXEL_FORMAT_RGB:
+			return 3;
+		case ARToolKitPlus::PIXEL_FORMAT_RGB565:
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+//--------------------------------------------------
+// Every kernel works on pixels spread out to one per 32 bit lane, byte k of the
+// pixel in bits 8k to 8k+7, and sums the bytes times their weight.
+// The products stay below 2^16, so a 16 bit multiply is enough.
+
+#ifdef OFX_ARTKP_SSE2
+static inline __m128i grayLanes(__m128i pixels, const __m128i weights[4]) {
+	const __m128i mask = _mm_set1_epi32(0xff);
+	__m128i sum = _mm_set1_epi32(128);
+	sum = _mm_add_epi32(sum, _mm_mullo_epi16(_mm_and_si128(pixels, mask), weights[0]));
+	sum = _mm_add_epi32(sum, _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(pixels, 8), mask), weights[1]));
+	sum = _mm_add_epi32(sum, _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(pixels, 16), mask), weights[2]));
+	sum = _mm_add_epi32(sum, _mm_mullo_epi16(_mm_srli_epi32(pixels, 24), weights[3]));
+	return _mm_srli_epi32(sum, 8);
+}
+
+static inline void storeGray16(unsigned char *dst, __m128i a, __m128i b, __m128i c, __m128i d) {
+	_mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+}
+#endif
+
+#ifdef OFX_ARTKP_AVX2
+static inline __m256i grayLanes256(__m256i pixels, const __m256i weights[4]) {
+	const __m256i mask = _mm256_set1_epi32(0xff);
+	__m256i sum = _mm256_set1_epi32(128);
+	sum = _mm256_add_epi32(sum, _mm256_mullo_epi16(_mm256_and_si256(pixels, mask), weights[0]));
+	sum = _mm256_add_epi32(sum, _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask), weights[1]));
+	sum = _mm256_add_epi32(sum, _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask), weights[2]));
+	sum = _mm256_add_epi32(sum, _mm256_mullo_epi16(_mm256_srli_epi32(pixels, 24), weights[3]));
+	return _mm256_srli_epi32(sum, 8);
+}
+#endif
+
+// Pixels of 4 bytes are already one per lane
+static int convert4(const unsigned char *src, unsigned char *dst, int numPixels, const int w[4]) {
+	int i = 0;
+#if defined(OFX_ARTKP_AVX2)
+	__m256i weights[4];
+	for(int k=0; k<4; k++) {
+		weights[k] = _mm256_set1_epi32(w[k]);
+	}
+	// packs and packus work within 128 bit halves, this puts the pixels back in order
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	for(; i + 32 <= numPixels; i += 32) {
+		const __m256i *in = (const __m256i*)(src + i * 4);
+		__m256i a = grayLanes256(_mm256_loadu_si256(in), weights);
+		__m256i b = grayLanes256(_mm256_loadu_si256(in + 1), weights);
+		__m256i c = grayLanes256(_mm256_loadu_si256(in + 2), weights);
+		__m256i d = grayLanes256(_mm256_loadu_si256(in + 3), weights);
+		__m256i gray = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_permutevar8x32_epi32(gray, order));
+	}
+#endif
+#if defined(OFX_ARTKP_SSE2)
+	__m128i weights128[4];
+	for(int k=0; k<4; k++) {
+		weights128[k] = _mm_set1_epi32(w[k]);
+	}
+	for(; i + 16 <= numPixels; i += 16) {
+		const __m128i *in = (const __m128i*)(src + i * 4);
+		storeGray16(dst + i,
+					grayLanes(_mm_loadu_si128(in), weights128),
+					grayLanes(_mm_loadu_si128(in + 1), weights128),
+					grayLanes(_mm_loadu_si128(in + 2), weights128),
+					grayLanes(_mm_loadu_si128(in + 3), weights128));
+	}
+#else
+	// Everything is left to the plain loop
+	(void)src; (void)dst; (void)numPixels; (void)w;
+#endif
+	return i;
+}
+
+// Pixels of 3 bytes are shuffled out to one per lane, 4 at a time
+static int convert3(const unsigned char *src, unsigned char *dst, int numPixels, const int w[4]) {
+	int i = 0;
+#if defined(OFX_ARTKP_SSSE3)
+	__m128i weights[4];
+	for(int k=0; k<4; k++) {
+		weights[k] = _mm_set1_epi32(w[k]);
+	}
+	const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	// Each load reads 16 bytes but only uses 12, the last one reads into the next 2 pixels
+	for(; i + 18 <= numPixels; i += 16) {
+		const unsigned char *in = src + i * 3;
+		storeGray16(dst + i,
+					grayLanes(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)in), spread), weights),
+					grayLanes(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + 12)), spread), weights),
+					grayLanes(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + 24)), spread), weights),
+					grayLanes(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + 36)), spread), weights));
+	}
+#else
+	// Everything is left to the plain loop
+	(void)src; (void)dst; (void)numPixels; (void)w;
+#endif
+	return i;
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusConvertToGray(const unsigned char *src, unsigned char *dst, int numPixels, ARToolKitPlus::PIXEL_FORMAT format) {
+	
+	// Weight of every byte of a pixel
+	int w[4] = {0, 0, 0, 0};
+	switch(format) {
+		case ARToolKitPlus::PIXEL_FORMAT_LUM:
+			memcpy(dst, src, numPixels);
+			return;
+		case ARToolKitPlus::PIXEL_FORMAT_RGB565: {
+			const unsigned short *in = (const unsigned short*)src;
+			for(int i=0; i<numPixels; i++) {
+				int r = (in[i] >> 11) & 0x1f, g = (in[i] >> 5) & 0x3f, b = in[i] & 0x1f;
+				r = (r << 3) | (r >> 2);
+				g = (g << 2) | (g >> 4);
+				b = (b << 3) | (b >> 2);
+				dst[i] = (GRAY_R*r + GRAY_G*g + GRAY_B*b + 128) >> 8;
+			}
+			return;
+		}
+		case ARToolKitPlus::PIXEL_FORMAT_RGB:
+		case ARToolKitPlus::PIXEL_FORMAT_RGBA:
+			w[0] = GRAY_R; w[1] = GRAY_G; w[2] = GRAY_B;
+			break;
+		case ARToolKitPlus::PIXEL_FORMAT_BGR:
+		case ARToolKitPlus::PIXEL_FORMAT_BGRA:
+			w[0] = GRAY_B; w[1] = GRAY_G; w[2] = GRAY_R;
+			break;
+		case ARToolKitPlus::PIXEL_FORMAT_ABGR:
+			w[1] = GRAY_B; w[2] = GRAY_G; w[3] = GRAY_R;
+			break;
+	}
+	
+	int bytesPerPixel = ofxARToolkitPlusGetBytesPerPixel(format);
+	int i = bytesPerPixel == 4 ? convert4(src, dst, numPixels, w) : convert3(src, dst, numPixels, w);
+	
+	// Whatever the vector loops left over
+	for(const unsigned char *in = src + i * bytesPerPixel; i<numPixels; i++, in += bytesPerPixel) {
+		int sum = w[0]*in[0] + w[1]*in[1] + w[2]*in[2] + 128;
+		if(bytesPerPixel == 4) {
+			sum += w[3]*in[3];
+		}
+		dst[i] = sum >> 8;
+	}
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusExtractLuma(const unsigned char *src, unsigned char *dst, int numPixels) {
+	int i = 0;
+#if defined(OFX_ARTKP_SSE2)
+	// Every other byte from src, so the last load reads one byte past the last Y sample
+	const __m128i mask = _mm_set1_epi16(0xff);
+	for(; i + 17 <= numPixels; i += 16) {
+		__m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + i * 2)), mask);
+		__m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + i * 2 + 16)), mask);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+	}
+#endif
+	for(; i<numPixels; i++) {
+		dst[i] = src[i * 2];
+	}
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusHalveImage(const unsigned char *src, int width, int height, unsigned char *dst) {
+	int dstWidth = width / 2;
+	int dstHeight = height / 2;
+	for(int y=0; y<dstHeight; y++) {
+		const unsigned char *row0 = src + (y * 2) * width;
+		const unsigned char *row1 = row0 + width;
+		unsigned char *out = dst + y * dstWidth;
+		int x = 0;
+#if defined(OFX_ARTKP_SSE2)
+		// Sum the even and odd bytes of both rows in 16 bit lanes, 16 output pixels at a time
+		const __m128i mask = _mm_set1_epi16(0xff);
+		const __m128i round = _mm_set1_epi16(2);
+		for(; x + 16 <= dstWidth; x += 16) {
+			__m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + x * 2));
+			__m128i a1 = _mm_loadu_si128((const __m128i*)(row1 + x * 2));
+			__m128i b0 = _mm_loadu_si128((const __m128i*)(row0 + x * 2 + 16));
+			__m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + x * 2 + 16));
+			__m128i a = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a0, mask), _mm_srli_epi16(a0, 8)), _mm_add_epi16(_mm_and_si128(a1, mask), _mm_srli_epi16(a1, 8)));
+			__m128i b = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(b0, mask), _mm_srli_epi16(b0, 8)), _mm_add_epi16(_mm_and_si128(b1, mask), _mm_srli_epi16(b1, 8)));
+			a = _mm_srli_epi16(_mm_add_epi16(a, round), 2);
+			b = _mm_srli_epi16(_mm_add_epi16(b, round), 2);
+			_mm_storeu_si128((__m128i*)(out + x), _mm_packus_epi16(a, b));
+		}
+#endif
+		for(; x<dstWidth; x++) {
+			out[x] = (row0[x * 2] + row0[x * 2 + 1] + row1[x * 2] + row1[x * 2 + 1] + 2) >> 2;
+		}
+	}
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusThresholdMask(const unsigned char *src, int numPixels, int threshold, uint64_t *mask) {
+	int numWords = (numPixels + 63) / 64;
+	if(threshold < 0) {
+		memset(mask, 0, numWords * sizeof(uint64_t));
+		return;
+	}
+	threshold = threshold > 255 ? 255 : threshold;
+	int i = 0;
+#if defined(OFX_ARTKP_AVX2)
+	// A pixel is dark where min(pixel, threshold) is the pixel itself
+	const __m256i limit256 = _mm256_set1_epi8((char)threshold);
+	for(; i + 64 <= numPixels; i += 64) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 32));
+		uint64_t low = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(a, limit256), a));
+		uint64_t high = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(b, limit256), b));
+		mask[i / 64] = low | (high << 32);
+	}
+#endif
+#if defined(OFX_ARTKP_SSE2)
+	const __m128i limit = _mm_set1_epi8((char)threshold);
+	for(; i + 64 <= numPixels; i += 64) {
+		uint64_t word = 0;
+		for(int k=0; k<4; k++) {
+			__m128i pixels = _mm_loadu_si128((const __m128i*)(src + i + k * 16));
+			uint64_t bits = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(pixels, limit), pixels));
+			word |= bits << (k * 16);
+		}
+		mask[i / 64] = word;
+	}
+#endif
+	// The last word, or all of them without SIMD
+	for(; i<numPixels; i+=64) {
+		uint64_t word = 0;
+		int end = numPixels - i < 64 ? numPixels - i : 64;
+		for(int k=0; k<end; k++) {
+			if(src[i + k] <= threshold) {
+				word |= (uint64_t)1 << k;
+			}
+		}
+		mask[i / 64] = word;
+	}
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusIntegralImage(const unsigned char *src, int stride, int width, int height, uint32_t *integral) {
+	int integralWidth = width + 1;
+	memset(integral, 0, integralWidth * sizeof(uint32_t));
+	for(int y=0; y<height; y++) {
+		const unsigned char *row = src + y * stride;
+		const uint32_t *above = integral + y * integralWidth;
+		uint32_t *out = integral + (y + 1) * integralWidth;
+		out[0] = 0;
+		uint32_t sum = 0;
+		int x = 0;
+#if defined(OFX_ARTKP_SSE2)
+		// Prefix sums of 4 pixels at a time in 32 bit lanes, the total so far carried in every lane
+		const __m128i zero = _mm_setzero_si128();
+		__m128i carry = zero;
+		for(; x + 16 <= width; x += 16) {
+			__m128i pixels = _mm_loadu_si128((const __m128i*)(row + x));
+			__m128i low = _mm_unpacklo_epi8(pixels, zero);
+			__m128i high = _mm_unpackhi_epi8(pixels, zero);
+			__m128i quads[4] = { _mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero), _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero) };
+			for(int k=0; k<4; k++) {
+				__m128i v = quads[k];
+				v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+				v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+				v = _mm_add_epi32(v, carry);
+				carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128i sums = _mm_add_epi32(v, _mm_loadu_si128((const __m128i*)(above + x + k * 4 + 1)));
+				_mm_storeu_si128((__m128i*)(out + x + k * 4 + 1), sums);
+			}
+		}
+		sum = (uint32_t)_mm_cvtsi128_si32(carry);
+#endif
+		for(; x<width; x++) {
+			sum += row[x];
+			out[x + 1] = above[x + 1] + sum;
+		}
+	}
+}
+
+// Rounded mean minus offset, clamped to a pixel value. Same rounding as the SIMD path
+static inline unsigned char localLimit(uint32_t sum, float scale, int offset) {
+	int limit = (int)(sum * scale + 0.5f) - offset;
+	return limit < 0 ? 0 : (limit > 255 ? 255 : limit);
+}
+
+// Limit of pixel x of a row whose box may be cut off by the ends of the rows
+static inline unsigned char clippedLimit(const uint32_t *top, const uint32_t *bottom, int width, int boxHeight, int x, int halfWindow, int offset) {
+	int x0 = std::max(x - halfWindow, 0);
+	int x1 = std::min(x + halfWindow + 1, width);
+	return localLimit(bottom[x1] - bottom[x0] - top[x1] + top[x0], 1.0f / ((x1 - x0) * boxHeight), offset);
+}
+
+void ofxARToolkitPlusLocalThresholdMask(const unsigned char *src, const uint32_t *top, const uint32_t *bottom, int width, int boxHeight, int first, int numPixels, int halfWindow, int offset, uint64_t *mask) {
+	// Only the boxes near the ends of the rows are cut off, all the others have the same area
+	int begin = std::min(std::max(halfWindow - first, 0), numPixels);
+	int end = std::max(std::min(width - halfWindow - first, numPixels), begin);
+	const float scale = 1.0f / ((2 * halfWindow + 1) * boxHeight);
+	const uint32_t *topLeft = top + first - halfWindow;
+	const uint32_t *topRight = top + first + halfWindow + 1;
+	const uint32_t *bottomLeft = bottom + first - halfWindow;
+	const uint32_t *bottomRight = bottom + first + halfWindow + 1;
+	memset(mask, 0, (numPixels + 63) / 64 * sizeof(uint64_t));
+	int i = begin;
+#if defined(OFX_ARTKP_SSE2)
+	const __m128 scale4 = _mm_set1_ps(scale);
+	const __m128 half4 = _mm_set1_ps(0.5f);
+	const __m128i offset4 = _mm_set1_epi32(offset);
+	const __m128i zero = _mm_setzero_si128();
+	for(; i + 16 <= end; i += 16) {
+		// Box sums of 16 pixels in 4 lanes each, their means rounded and clamped to 0 - 255 by the packs
+		__m128i quads[4];
+		for(int q=0; q<4; q++) {
+			int n = i + q * 4;
+			__m128i sum = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(bottomRight + n)), _mm_loadu_si128((const __m128i*)(bottomLeft + n)));
+			sum = _mm_add_epi32(_mm_sub_epi32(sum, _mm_loadu_si128((const __m128i*)(topRight + n))), _mm_loadu_si128((const __m128i*)(topLeft + n)));
+			__m128 mean = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale4), half4);
+			quads[q] = _mm_sub_epi32(_mm_cvttps_epi32(mean), offset4);
+		}
+		__m128i limit = _mm_packus_epi16(_mm_packs_epi32(quads[0], quads[1]), _mm_packs_epi32(quads[2], quads[3]));
+		// A pixel is dark where limit - pixel does not saturate to 0
+		__m128i pixels = _mm_loadu_si128((const __m128i*)(src + i));
+		uint64_t dark = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(limit, pixels), zero)) & 0xffff;
+		// The 16 bits may start anywhere in a word and run over into the next one
+		int bit = i % 64;
+		mask[i / 64] |= dark << bit;
+		if(bit > 48) {
+			mask[i / 64 + 1] |= dark >> (64 - bit);
+		}
+	}
+#endif
+	for(; i<end; i++) {
+		if(src[i] < localLimit(bottomRight[i] - bottomLeft[i] - topRight[i] + topLeft[i], scale, offset)) {
+			mask[i / 64] |= (uint64_t)1 << (i % 64);
+		}
+	}
+	// The pixels whose box is cut off
+	for(int i=0; i<begin; i++) {
+		if(src[i] < clippedLimit(top, bottom, width, boxHeight, first + i, halfWindow, offset)) {
+			mask[i / 64] |= (uint64_t)1 << (i % 64);
+		}
+	}
+	for(int i=end; i<numPixels; i++) {
+		if(src[i] < clippedLimit(top, bottom, width, boxHeight, first + i, halfWindow, offset)) {
+			mask[i / 64] |= (uint64_t)1 << (i % 64);
+		}
+	}
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusAddToHistogram(const unsigned char *src, int numPixels, int step, unsigned int *histogram) {
+	for(int i=0; i<numPixels; i+=step) {
+		histogram[src[i]]++;
+	}
+}
+
+int ofxARToolkitPlusOtsuThreshold(const unsigned int *histogram) {
+	double total = 0, sum = 0;
+	for(int i=0; i<256; i++) {
+		total += histogram[i];
+		sum += (double)i * histogram[i];
+	}
+	if(total == 0) {
+		return -1;
+	}
+	// Between class variance of [0, t] and [t + 1, 255], up to the constant factor 1 / total^2.
+	// Every threshold in a gap of the histogram splits it the same, take the middle of the gap
+	double darkCount = 0, darkSum = 0, best = -1;
+	int first = -1, last = -1;
+	for(int t=0; t<255; t++) {
+		darkCount += histogram[t];
+		darkSum += (double)t * histogram[t];
+		double lightCount = total - darkCount;
+		if(darkCount == 0 || lightCount == 0) {
+			continue;
+		}
+		double difference = darkSum / darkCount - (sum - darkSum) / lightCount;
+		double variance = darkCount * lightCount * difference * difference;
+		if(variance > best * (1 + 1e-9)) {
+			best = variance;
+			first = last = t;
+		}
+		else if(variance >= best * (1 - 1e-9)) {
+			last = t;
+		}
+	}
+	return first < 0 ? -1 : (first + last) / 2;
+}
+
+int ofxARToolkitPlusBimodalThreshold(const unsigned int *histogram) {
+	double smoothed[256], previous[256];
+	for(int i=0; i<256; i++) {
+		smoothed[i] = histogram[i];
+	}
+	// Smooth with a running mean of 3 until only two peaks are left (Prewitt and Mendelsohn)
+	for(int iteration=0; iteration<1000; iteration++) {
+		int numPeaks = 0;
+		for(int i=1; i<255; i++) {
+			if(smoothed[i - 1] < smoothed[i] && smoothed[i + 1] < smoothed[i]) {
+				numPeaks++;
+			}
+		}
+		if(numPeaks == 2) {
+			// The bottom of the valley after the first peak
+			for(int i=1; i<255; i++) {
+				if(smoothed[i - 1] > smoothed[i] && smoothed[i + 1] >= smoothed[i]) {
+					return i;
+				}
+			}
+		}
+		if(numPeaks < 2) {
+			return -1;
+		}
+		memcpy(previous, smoothed, sizeof(previous));
+		smoothed[0] = (previous[0] + previous[1]) / 3;
+		for(int i=1; i<255; i++) {
+			smoothed[i] = (previous[i - 1] + previous[i] + previous[i + 1]) / 3;
+		}
+		smoothed[255] = (previous[254] + previous[255]) / 3;
+	}
+	return -1;
+}
+
+//--------------------------------------------------
+// Sums over the window for the corner (qx, qy) solving
+// [xx xy; xy yy] q = [bx; by], all relative to the center pixel
+struct CornerSums {
+	float xx, xy, yy, bx, by;
+};
+
+#ifdef OFX_ARTKP_SSE2
+// 4 pixels as floats
+static inline __m128 load4(const unsigned char *p) {
+	int pixels;
+	memcpy(&pixels, p, 4);
+	const __m128i zero = _mm_setzero_si128();
+	return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(pixels), zero), zero));
+}
+#endif
+
+static void sumCornerWindow(const unsigned char *image, int width, int cx, int cy, int halfWindow, const float *weightsX, const float *weightsY, CornerSums &sums) {
+	sums.xx = sums.xy = sums.yy = sums.bx = sums.by = 0;
+	int size = halfWindow * 2 + 1;
+#if defined(OFX_ARTKP_SSE2)
+	__m128 xx = _mm_setzero_ps(), xy = _mm_setzero_ps(), yy = _mm_setzero_ps(), bx = _mm_setzero_ps(), by = _mm_setzero_ps();
+#endif
+	for(int j=0; j<size; j++) {
+		int dy = j - halfWindow;
+		const unsigned char *row = image + (cy + dy) * width + cx - halfWindow;
+		float rowWeight = weightsY[j];
+		int i = 0;
+#if defined(OFX_ARTKP_SSE2)
+		// Scharr gradients of 4 pixels at a time, in floats
+		const __m128 wy = _mm_set1_ps(rowWeight);
+		const __m128 fy = _mm_set1_ps((float)dy);
+		const __m128 outer = _mm_set1_ps(3), inner = _mm_set1_ps(10);
+		for(; i + 4 <= size; i += 4) {
+			const unsigned char *p = row + i;
+			__m128 gx = _mm_add_ps(_mm_mul_ps(inner, _mm_sub_ps(load4(p + 1), load4(p - 1))),
+								   _mm_mul_ps(outer, _mm_add_ps(_mm_sub_ps(load4(p - width + 1), load4(p - width - 1)), _mm_sub_ps(load4(p + width + 1), load4(p + width - 1)))));
+			__m128 gy = _mm_add_ps(_mm_mul_ps(inner, _mm_sub_ps(load4(p + width), load4(p - width))),
+								   _mm_mul_ps(outer, _mm_add_ps(_mm_sub_ps(load4(p + width - 1), load4(p - width - 1)), _mm_sub_ps(load4(p + width + 1), load4(p - width + 1)))));
+			__m128 w = _mm_mul_ps(_mm_loadu_ps(weightsX + i), wy);
+			__m128 fx = _mm_add_ps(_mm_set1_ps((float)(i - halfWindow)), _mm_setr_ps(0, 1, 2, 3));
+			__m128 gxx = _mm_mul_ps(_mm_mul_ps(gx, gx), w);
+			__m128 gxy = _mm_mul_ps(_mm_mul_ps(gx, gy), w);
+			__m128 gyy = _mm_mul_ps(_mm_mul_ps(gy, gy), w);
+			xx = _mm_add_ps(xx, gxx);
+			xy = _mm_add_ps(xy, gxy);
+			yy = _mm_add_ps(yy, gyy);
+			bx = _mm_add_ps(bx, _mm_add_ps(_mm_mul_ps(gxx, fx), _mm_mul_ps(gxy, fy)));
+			by = _mm_add_ps(by, _mm_add_ps(_mm_mul_ps(gxy, fx), _mm_mul_ps(gyy, fy)));
+		}
+#endif
+		for(; i<size; i++) {
+			int dx = i - halfWindow;
+			const unsigned char *p = row + i;
+			float gx = (float)(10 * (p[1] - p[-1]) + 3 * (p[-width + 1] - p[-width - 1] + p[width + 1] - p[width - 1]));
+			float gy = (float)(10 * (p[width] - p[-width]) + 3 * (p[width - 1] - p[-width - 1] + p[width + 1] - p[-width + 1]));
+			float w = weightsX[i] * rowWeight;
+			float gxx = gx * gx * w, gxy = gx * gy * w, gyy = gy * gy * w;
+			sums.xx += gxx;
+			sums.xy += gxy;
+			sums.yy += gyy;
+			sums.bx += gxx * dx + gxy * dy;
+			sums.by += gxy * dx + gyy * dy;
+		}
+	}
+#if defined(OFX_ARTKP_SSE2)
+	float lanes[4];
+	_mm_storeu_ps(lanes, xx); sums.xx += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm_storeu_ps(lanes, xy); sums.xy += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm_storeu_ps(lanes, yy); sums.yy += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm_storeu_ps(lanes, bx); sums.bx += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm_storeu_ps(lanes, by); sums.by += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+}
+
+bool ofxARToolkitPlusRefineCorner(const unsigned char *image, int width, int height, float *x, float *y, int halfWindow, int maxIterations) {
+	const int maxHalfWindow = 16;
+	if(halfWindow < 1 || halfWindow > maxHalfWindow) {
+		return false;
+	}
+	int size = halfWindow * 2 + 1;
+	float sigma2 = 2.0f * halfWindow * halfWindow;
+	float weightsX[maxHalfWindow * 2 + 1];
+	float weightsY[maxHalfWindow * 2 + 1];
+
+	float px = *x, py = *y;
+	for(int iteration=0; iteration<maxIterations; iteration++) {
+		int cx = (int)floorf(px + 0.5f);
+		int cy = (int)floorf(py + 0.5f);
+		// The gradients read one pixel past the window
+		if(cx - halfWindow < 1 || cy - halfWindow < 1 || cx + halfWindow > width - 2 || cy + halfWindow > height - 2) {
+			return false;
+		}
+		// Gaussian weights around the current estimate, not the pixel it falls in,
+		// or the corner is pulled towards the pixel center
+		for(int i=0; i<size; i++) {
+			float dx = i - halfWindow - (px - cx);
+			float dy = i - halfWindow - (py - cy);
+			weightsX[i] = expf(-dx * dx / sigma2);
+			weightsY[i] = expf(-dy * dy / sigma2);
+		}
+		CornerSums sums;
+		sumCornerWindow(image, width, cx, cy, halfWindow, weightsX, weightsY, sums);
+		// Gradients of a single edge (or none) do not pin down a point
+		float det = sums.xx * sums.yy - sums.xy * sums.xy;
+		float trace = sums.xx + sums.yy;
+		if(trace <= 0 || det < 1e-3f * trace * trace) {
+			return false;
+		}
+		float qx = (sums.yy * sums.bx - sums.xy * sums.by) / det;
+		float qy = (sums.xx * sums.by - sums.xy * sums.bx) / det;
+		if(fabsf(qx) > halfWindow || fabsf(qy) > halfWindow) {
+			return false;
+		}
+		float step = fabsf(cx + qx - px) + fabsf(cy + qy - py);
+		px = cx + qx;
+		py = cy + qy;
+		if(step < 0.01f) {
+			break;
+		}
+	}
+	// A corner that wandered off is some other corner
+	if(fabsf(px - *x) > halfWindow || fabsf(py - *y) > halfWindow) {
+		return false;
+	}
+	*x = px;
+	*y = py;
+	return true;
+}
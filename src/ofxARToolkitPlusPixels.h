@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ARToolKitPlus/ARToolKitPlus.h"
+
+#include <stdint.h>
+
+/*
+ * Conversion of camera pixels to the 8 bit luminance ARToolKitPlus tracks on,
+ * and the image kernels ofxARToolkitPlusTracker runs on it.
+ * Color is weighted by ITU-R BT.601 in 1/256, which stays within one gray level of
+ * OpenCV's cvtColor and ofxCvGrayscaleImage. The inner loops use SSE2, SSSE3 or AVX2
+ * when the compiler targets them and fall back to plain C++ otherwise.
+ */
+
+/* Bytes per pixel of the format */
+int ofxARToolkitPlusGetBytesPerPixel(ARToolKitPlus::PIXEL_FORMAT format);
+
+/* Convert numPixels pixels of the given format from src into gray pixels in dst */
+void ofxARToolkitPlusConvertToGray(const unsigned char *src, unsigned char *dst, int numPixels, ARToolKitPlus::PIXEL_FORMAT format);
+
+/* Copy numPixels Y samples of a packed 4:2:2 row (YUYV or UYVY) from src, which points at the first Y sample, into dst */
+void ofxARToolkitPlusExtractLuma(const unsigned char *src, unsigned char *dst, int numPixels);
+
+/* Shrink a gray image to half its width and height, every pixel the rounded mean of a 2x2 block.
+ * dst has (width / 2) * (height / 2) pixels, an odd last row or column is left out */
+void ofxARToolkitPlusHalveImage(const unsigned char *src, int width, int height, unsigned char *dst);
+
+/* Set bit i % 64 of mask[i / 64] for every dark pixel i of the numPixels in src, those at most threshold.
+ * mask has (numPixels + 63) / 64 words, the bits past the last pixel are 0 */
+void ofxARToolkitPlusThresholdMask(const unsigned char *src, int numPixels, int threshold, uint64_t *mask);
+
+/* Sum up the gray image of width x height pixels, stride bytes from row to row, into integral:
+ * (width + 1) x (height + 1) values, the one at (x, y) the sum of all pixels above and left of it.
+ * The sums wrap around past 32 bits, sums over boxes of less than 2^32 come out right anyway */
+void ofxARToolkitPlusIntegralImage(const unsigned char *src, int stride, int width, int height, uint32_t *integral);
+
+/* Same as ofxARToolkitPlusThresholdMask with a threshold for every pixel, starting at column first of a
+ * row of an integral image width pixels wide: a pixel is dark if it is more than offset below the rounded
+ * mean of the box of 2 * halfWindow + 1 columns around it, cut off at the ends of the row. top and bottom
+ * are the rows of the integral image at the top and the bottom of the boxes, boxHeight rows apart */
+void ofxARToolkitPlusLocalThresholdMask(const unsigned char *src, const uint32_t *top, const uint32_t *bottom, int width, int boxHeight, int first, int numPixels, int halfWindow, int offset, uint64_t *mask);
+
+/* Count every step-th of numPixels pixels of src into a histogram of 256 gray values */
+void ofxARToolkitPlusAddToHistogram(const unsigned char *src, int numPixels, int step, unsigned int *histogram);
+
+/* Threshold splitting a histogram of 256 gray values into the dark (at most the threshold) and the light
+ * pixels with the largest between class variance (Otsu's method). -1 if there are not two gray values */
+int ofxARToolkitPlusOtsuThreshold(const unsigned int *histogram);
+
+/* Threshold at the bottom of the valley between the two peaks of a histogram of 256 gray values,
+ * smoothed until only two are left. -1 if the histogram does not come down to two peaks */
+int ofxARToolkitPlusBimodalThreshold(const unsigned int *histogram);
+
+/* Move (x, y) to the sub-pixel corner in a (2 * halfWindow + 1) pixels square window around it:
+ * the point the Scharr gradients of the window all line up with (Foerstner's operator), weighted
+ * towards the middle. The window follows the point for at most maxIterations steps, so no more than
+ * maxIterations * (2 * halfWindow + 1)^2 pixels are read. Returns false and leaves the point alone
+ * if the window leaves the image or does not hold a corner */
+bool ofxARToolkitPlusRefineCorner(const unsigned char *image, int width, int height, float *x, float *y, int halfWindow, int maxIterations);
@@ -0,0 +1,1437 @@
+#include "ofxARToolkitPlusTracker.h"
+#include "ofxARToolkitPlusPixels.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdlib.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Every this many rows and columns of the labeled pixels are counted into the auto threshold
+// histogram, and every this many of the pixels around the markers
+static const int histogramStep = 4;
+static const int markerHistogramStep = 2;
+// Regions are only split into stripes of at least this many rows for the label threads
+static const int minStripeRows = 64;
+
+// Index of the lowest set bit, bits must not be 0
+static inline int countTrailingZeros(uint64_t bits) {
+#ifdef _MSC_VER
+	unsigned long index;
+	if(_BitScanForward(&index, (unsigned long)bits)) {
+		return index;
+	}
+	_BitScanForward(&index, (unsigned long)(bits >> 32));
+	return index + 32;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
+
+ofxARToolkitPlusTracker::ofxARToolkitPlusTracker(int width, int height, int maxImagePatterns, int pattWidth, int pattHeight, int pattSamples, int maxLoadPatterns)
+: ARToolKitPlus::TrackerMultiMarker(width, height, maxImagePatterns, pattWidth, pattHeight, pattSamples, maxLoadPatterns) {
+	scanRegions = NULL;
+	predictiveROI = false;
+	fullScanInterval = 30;
+	predictiveROIMargin = 0.5;
+	framesSinceFullScan = 0;
+	fullScanPending = true;
+	numROIFrames = 0;
+	numFullScanFrames = 0;
+	pyramidScale = 1;
+	cornerRefinement = false;
+	cornerHalfWindow = 4;
+	lastCornerRefineMicros = 0;
+	numRefinedCorners = 0;
+	adaptiveThreshold = false;
+	adaptiveHalfWindow = 32;
+	adaptiveOffset = 7;
+	lastLabelMicros = 0;
+	lastMultiMarkerPoseMicros = 0;
+	autoThresholdMethod = AUTO_THRESHOLD_RANDOM;
+	histogramAroundMarkers = true;
+	collectHistogram = false;
+	lastThresholdRetries = 0;
+	numThresholdRetries = 0;
+	tracks.reserve(maxImagePatterns);
+	nextTracks.reserve(maxImagePatterns);
+	predictedRegions.reserve(maxImagePatterns);
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusTracker::setDetectionROIs(const ofRectangle *rois, int count) {
+	detectionROIs.resize(count);
+	for(int i=0; i<count; i++) {
+		// Round outwards so every pixel the rectangle touches is searched
+		Region &region = detectionROIs[i];
+		region.x0 = floor(rois[i].x);
+		region.y0 = floor(rois[i].y);
+		region.x1 = ceil(rois[i].x + rois[i].width);
+		region.y1 = ceil(rois[i].y + rois[i].height);
+	}
+}
+
+int ofxARToolkitPlusTracker::getNumDetectionROIs() const {
+	return detectionROIs.size();
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusTracker::activatePredictiveROI(bool state) {
+	predictiveROI = state;
+	fullScanPending = true;
+}
+
+bool ofxARToolkitPlusTracker::isPredictiveROIActivated() const {
+	return predictiveROI;
+}
+
+void ofxARToolkitPlusTracker::setFullScanInterval(int frames) {
+	fullScanInterval = std::max(frames, 1);
+}
+
+void ofxARToolkitPlusTracker::setPredictiveROIMargin(float fraction) {
+	predictiveROIMargin = std::max(fraction, 0.0f);
+}
+
+void ofxARToolkitPlusTracker::setPyramidScale(int scale) {
+	if(scale != 1 && scale != 2 && scale != 4) {
+		ofLog(OF_LOG_ERROR, "ofxARToolkitPlusTracker: pyramid scale must be 1, 2 or 4");
+		return;
+	}
+	pyramidScale = scale;
+}
+
+int ofxARToolkitPlusTracker::getPyramidScale() const {
+	return pyramidScale;
+}
+
+void ofxARToolkitPlusTracker::activateCornerRefinement(bool state, int halfWindow) {
+	cornerRefinement = state;
+	cornerHalfWindow = std::min(std::max(halfWindow, 1), 16);
+}
+
+bool ofxARToolkitPlusTracker::isCornerRefinementActivated() const {
+	return cornerRefinement;
+}
+
+unsigned long long ofxARToolkitPlusTracker::getLastCornerRefineMicros() const {
+	return lastCornerRefineMicros;
+}
+
+int ofxARToolkitPlusTracker::getNumRefinedCorners() const {
+	return numRefinedCorners;
+}
+
+void ofxARToolkitPlusTracker::activateAdaptiveThreshold(bool state, int halfWindow, int offset) {
+	if(halfWindow < 1) {
+		ofLog(OF_LOG_ERROR, "ofxARToolkitPlusTracker: adaptive threshold window must be at least 1");
+		return;
+	}
+	adaptiveThreshold = state;
+	adaptiveHalfWindow = halfWindow;
+	adaptiveOffset = offset;
+}
+
+bool ofxARToolkitPlusTracker::isAdaptiveThresholdActivated() const {
+	return adaptiveThreshold;
+}
+
+void ofxARToolkitPlusTracker::setAutoThresholdMethod(AutoThresholdMethod method, bool aroundMarkers) {
+	autoThresholdMethod = method;
+	histogramAroundMarkers = aroundMarkers;
+}
+
+ofxARToolkitPlusTracker::AutoThresholdMethod ofxARToolkitPlusTracker::getAutoThresholdMethod() const {
+	return autoThresholdMethod;
+}
+
+void ofxARToolkitPlusTracker::setNumAutoThresholdRetries(int numRetries) {
+	autoThreshold.numRandomRetries = std::max(numRetries, 1);
+}
+
+int ofxARToolkitPlusTracker::getLastThresholdRetries() const {
+	return lastThresholdRetries;
+}
+
+unsigned int ofxARToolkitPlusTracker::getNumThresholdRetries() const {
+	return numThresholdRetries;
+}
+
+void ofxARToolkitPlusTracker::resetThresholdRetries() {
+	numThresholdRetries = 0;
+}
+
+unsigned int ofxARToolkitPlusTracker::getNumROIFrames() const {
+	return numROIFrames;
+}
+
+unsigned int ofxARToolkitPlusTracker::getNumFullScanFrames() const {
+	return numFullScanFrames;
+}
+
+void ofxARToolkitPlusTracker::resetScanCounters() {
+	numROIFrames = 0;
+	numFullScanFrames = 0;
+}
+
+void ofxARToolkitPlusTracker::setNumLabelThreads(int numThreads) {
+	labelPool.setup(std::max(numThreads, 1));
+}
+
+int ofxARToolkitPlusTracker::getNumLabelThreads() const {
+	return labelPool.getNumThreads();
+}
+
+unsigned long long ofxARToolkitPlusTracker::getLastLabelMicros() const {
+	return lastLabelMicros;
+}
+
+unsigned long long ofxARToolkitPlusTracker::getLastMultiMarkerPoseMicros() const {
+	return lastMultiMarkerPoseMicros;
+}
+
+const ofxARToolkitPlusFrameArena& ofxARToolkitPlusTracker::getFrameArena() const {
+	return frameArena;
+}
+
+std::mutex& ofxARToolkitPlusTracker::getLibraryMutex() {
+	static std::mutex libraryMutex;
+	return libraryMutex;
+}
+
+//--------------------------------------------------
+int ofxARToolkitPlusTracker::calc(const uint8_t *nImage) {
+	// Frames without markers return before the multi-marker pose
+	lastMultiMarkerPoseMicros = 0;
+	return ARToolKitPlus::TrackerMultiMarker::calc(nImage);
+}
+
+int ofxARToolkitPlusTracker::arDetectMarker(const uint8_t *dataPtr, int threshold, ARToolKitPlus::ARMarkerInfo **marker_info, int *marker_num) {
+	*marker_num = 0;
+	if(!detectCandidates(dataPtr, threshold)) {
+		updateTracks(0);
+		return -1;
+	}
+	// The history adds the markers it remembers after the ones found in this frame
+	int numFound = wmarker_num;
+	matchPreviousMarkers();
+	updateTracks(numFound);
+
+	*marker_num = wmarker_num;
+	*marker_info = wmarker_info;
+	updateAutoThreshold(dataPtr);
+	return 0;
+}
+
+int ofxARToolkitPlusTracker::arDetectMarkerLite(const uint8_t *dataPtr, int threshold, ARToolKitPlus::ARMarkerInfo **marker_info, int *marker_num) {
+	*marker_num = 0;
+	if(!detectCandidates(dataPtr, threshold)) {
+		updateTracks(0);
+		return -1;
+	}
+	for(int i=0; i<wmarker_num; i++) {
+		if(wmarker_info[i].cf < 0.5) {
+			wmarker_info[i].id = -1;
+		}
+	}
+	updateTracks(wmarker_num);
+
+	*marker_num = wmarker_num;
+	*marker_info = wmarker_info;
+	updateAutoThreshold(dataPtr);
+	return 0;
+}
+
+ARFloat ofxARToolkitPlusTracker::executeMultiMarkerPoseEstimator(ARToolKitPlus::ARMarkerInfo *marker_info, int marker_num, ARToolKitPlus::ARMultiMarkerInfoT *config) {
+	std::lock_guard<std::mutex> lock(getLibraryMutex());
+	unsigned long long start = ofGetElapsedTimeMicros();
+	ARFloat error = ARToolKitPlus::TrackerMultiMarker::executeMultiMarkerPoseEstimator(marker_info, marker_num, config);
+	lastMultiMarkerPoseMicros = ofGetElapsedTimeMicros() - start;
+	return error;
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusTracker::checkLabelBuffer() {
+	int size = arImXsize * arImYsize;
+	if(l_imageL_size != size) {
+		delete[] l_imageL;
+		l_imageL = new int16_t[size];
+		l_imageL_size = size;
+	}
+}
+
+bool ofxARToolkitPlusTracker::detectCandidates(const uint8_t *dataPtr, int threshold) {
+	frameArena.reset();
+	autoThreshold.reset();
+	trackedCorners.clear();
+	checkLabelBuffer();
+	selectScanRegions();
+
+	int16_t *limage;
+	int label_num;
+	int *area, *clip, *label_ref;
+	ARFloat *pos;
+	bool fromHistogram = usesHistogramThreshold();
+	lastLabelMicros = 0;
+	for(lastThresholdRetries = 0;; lastThresholdRetries++) {
+		if(fromHistogram) {
+			memset(histogram, 0, sizeof(histogram));
+		}
+		collectHistogram = fromHistogram;
+		unsigned long long start = ofGetElapsedTimeMicros();
+		limage = labelImage(dataPtr, threshold, &label_num, &area, &pos, &clip, &label_ref);
+		lastLabelMicros += ofGetElapsedTimeMicros() - start;
+		collectHistogram = false;
+		if(limage) {
+			wmarker_num = findCandidates(limage, label_num, label_ref, area, pos, clip, AR_AREA_MAX, AR_AREA_MIN, 1.0);
+			wmarker_info = getMarkerInfo(dataPtr, threshold);
+			if(wmarker_num > 0) {
+				break;
+			}
+		}
+		// The adaptive threshold does not depend on thresh, trying others would find the same
+		if(!autoThreshold.enable || usesAdaptiveThreshold()) {
+			break;
+		}
+		if(fromHistogram) {
+			// Nothing found, try once more with the threshold of the pixels just labeled
+			// unless it is about the one that was used
+			int suggested = pickHistogramThreshold(dataPtr);
+			if(suggested < 0 || abs(suggested - threshold) <= 2 || lastThresholdRetries > 0) {
+				break;
+			}
+			thresh = threshold = suggested;
+			continue;
+		}
+		// Nothing found, try again with a random threshold. The next frame starts from the last one
+		thresh = threshold = (rand() % 230) + 10;
+		if(lastThresholdRetries == autoThreshold.numRandomRetries) {
+			break;
+		}
+	}
+	numThresholdRetries += lastThresholdRetries;
+	if(limage == NULL) {
+		return false;
+	}
+	refineCorners(dataPtr);
+	return true;
+}
+
+void ofxARToolkitPlusTracker::refineCorners(const uint8_t *image) {
+	lastCornerRefineMicros = 0;
+	numRefinedCorners = 0;
+	if(!cornerRefinement) {
+		return;
+	}
+	unsigned long long start = ofGetElapsedTimeMicros();
+	const int maxIterations = 4;
+	for(int i=0; i<wmarker_num; i++) {
+		ARToolKitPlus::ARMarkerInfo &marker = wmarker_info[i];
+
+		// Half the border width keeps the window, and the gradients just outside it,
+		// away from the edges inside the border
+		ARFloat side = 0;
+		for(int j=0; j<4; j++) {
+			ARFloat dx = marker.vertex[(j + 1) % 4][0] - marker.vertex[j][0];
+			ARFloat dy = marker.vertex[(j + 1) % 4][1] - marker.vertex[j][1];
+			side = j == 0 ? sqrt(dx * dx + dy * dy) : std::min(side, (ARFloat)sqrt(dx * dx + dy * dy));
+		}
+		int halfWindow = std::min((int)(side * relBorderWidth * 0.5f) - 1, cornerHalfWindow);
+		if(halfWindow < 2) {
+			continue;
+		}
+
+		// The vertices are undistorted, the image is not
+		bool moved = false;
+		for(int j=0; j<4; j++) {
+			ARFloat ox = marker.vertex[j][0];
+			ARFloat oy = marker.vertex[j][1];
+			if(undistMode != ARToolKitPlus::UNDIST_NONE) {
+				// Camera::ideal2Observ leaves the point in normalized camera coordinates
+				ARFloat nx, ny;
+				arCameraIdeal2Observ(arCamera, ox, oy, &nx, &ny);
+				ox = arCamera->mat[0][0] * nx + arCamera->mat[0][1] * ny + arCamera->mat[0][2];
+				oy = arCamera->mat[1][1] * ny + arCamera->mat[1][2];
+			}
+			float x = ox, y = oy;
+			if(!ofxARToolkitPlusRefineCorner(image, arImXsize, arImYsize, &x, &y, halfWindow, maxIterations)) {
+				continue;
+			}
+			if(undistMode != ARToolKitPlus::UNDIST_NONE) {
+				// UNDIST_LUT only has whole pixels
+				arCameraObserv2Ideal_std(arCamera, x, y, &marker.vertex[j][0], &marker.vertex[j][1]);
+			}
+			else {
+				marker.vertex[j][0] = x;
+				marker.vertex[j][1] = y;
+			}
+			numRefinedCorners++;
+			moved = true;
+		}
+		if(!moved) {
+			continue;
+		}
+
+		// Side j runs from vertex j to vertex j + 1, keep the direction of the normal the library picked
+		for(int j=0; j<4; j++) {
+			ARFloat *line = marker.line[j];
+			ARFloat dx = marker.vertex[(j + 1) % 4][0] - marker.vertex[j][0];
+			ARFloat dy = marker.vertex[(j + 1) % 4][1] - marker.vertex[j][1];
+			ARFloat length = sqrt(dx * dx + dy * dy);
+			if(length <= 0) {
+				continue;
+			}
+			ARFloat a = dy / length, b = -dx / length;
+			if(a * line[0] + b * line[1] < 0) {
+				a = -a;
+				b = -b;
+			}
+			line[0] = a;
+			line[1] = b;
+			line[2] = -(a * marker.vertex[j][0] + b * marker.vertex[j][1]);
+		}
+	}
+	lastCornerRefineMicros = ofGetElapsedTimeMicros() - start;
+}
+
+void ofxARToolkitPlusTracker::updateAutoThreshold(const uint8_t *image) {
+	if(!autoThreshold.enable) {
+		return;
+	}
+	if(!usesHistogramThreshold()) {
+		thresh = autoThreshold.calc();
+		return;
+	}
+	if(histogramAroundMarkers && !tracks.empty()) {
+		// Only the markers and a bit of what is around them
+		memset(histogram, 0, sizeof(histogram));
+		for(size_t i=0; i<tracks.size(); i++) {
+			const Track &track = tracks[i];
+			float margin = (track.maxX - track.minX + track.maxY - track.minY) / 16;
+			int x0 = std::max((int)(track.minX - margin), 0);
+			int y0 = std::max((int)(track.minY - margin), 0);
+			int x1 = std::min((int)(track.maxX + margin) + 1, arImXsize);
+			int y1 = std::min((int)(track.maxY + margin) + 1, arImYsize);
+			for(int y=y0; y<y1; y+=markerHistogramStep) {
+				ofxARToolkitPlusAddToHistogram(image + y * arImXsize + x0, x1 - x0, markerHistogramStep, histogram);
+			}
+		}
+	}
+	int threshold = pickHistogramThreshold(image);
+	if(threshold >= 0) {
+		thresh = threshold;
+	}
+}
+
+bool ofxARToolkitPlusTracker::usesHistogramThreshold() const {
+	return autoThreshold.enable && autoThresholdMethod != AUTO_THRESHOLD_RANDOM && !usesAdaptiveThreshold();
+}
+
+int ofxARToolkitPlusTracker::pickHistogramThreshold(const uint8_t *image) {
+	unsigned int total = 0;
+	for(int i=0; i<256; i++) {
+		total += histogram[i];
+	}
+	// arLabeling does not fill the histogram, sample what it labeled
+	if(total == 0) {
+		int width = arImXsize;
+		int height = arImYsize;
+		if(scanRegions == NULL) {
+			Region region = { 0, 0, width, height };
+			wholeImage.assign(1, region);
+		}
+		const vector<Region> &bounds = scanRegions ? *scanRegions : wholeImage;
+		for(size_t i=0; i<bounds.size(); i++) {
+			int x0 = std::max(bounds[i].x0, 0);
+			int x1 = std::min(bounds[i].x1, width);
+			for(int y=std::max(bounds[i].y0, 0); y<std::min(bounds[i].y1, height) && x0<x1; y+=histogramStep) {
+				ofxARToolkitPlusAddToHistogram(image + y * width + x0, x1 - x0, histogramStep, histogram);
+			}
+		}
+	}
+	if(autoThresholdMethod == AUTO_THRESHOLD_BIMODAL) {
+		int threshold = ofxARToolkitPlusBimodalThreshold(histogram);
+		if(threshold >= 0) {
+			return threshold;
+		}
+	}
+	return ofxARToolkitPlusOtsuThreshold(histogram);
+}
+
+bool ofxARToolkitPlusTracker::usesAdaptiveThreshold() const {
+	return adaptiveThreshold && arImageProcMode == AR_IMAGE_PROC_IN_FULL;
+}
+
+//--------------------------------------------------
+int ofxARToolkitPlusTracker::findCandidates(const int16_t *limage, int label_num, const int *label_ref, const int *warea, const ARFloat *wpos, const int *wclip, int area_max, int area_min, ARFloat factor) {
+	int xsize = arImXsize;
+	int ysize = arImYsize;
+	if(arImageProcMode == AR_IMAGE_PROC_IN_HALF) {
+		area_min /= 4;
+		area_max /= 4;
+		xsize /= 2;
+		ysize /= 2;
+	}
+	candidates.clear();
+	contour.clear();
+	for(int i=0; i<label_num && (int)candidates.size()<MAX_IMAGE_PATTERNS; i++) {
+		if(warea[i] < area_min || warea[i] > area_max) {
+			continue;
+		}
+		const int *clip = &wclip[i * 4];
+		if(clip[0] == 1 || clip[1] == xsize - 2 || clip[2] == 1 || clip[3] == ysize - 2) {
+			continue;
+		}
+		Candidate candidate;
+		if(!traceContour(limage, xsize, label_ref, i + 1, clip, warea[i], candidate)) {
+			continue;
+		}
+		if(!checkSquare(warea[i], factor, candidate)) {
+			contour.resize(candidate.first);
+			continue;
+		}
+		candidate.area = warea[i];
+		candidate.pos[0] = wpos[i * 2 + 0];
+		candidate.pos[1] = wpos[i * 2 + 1];
+		candidates.push_back(candidate);
+	}
+
+	// Of two candidates closer than half the side of the bigger one, only the bigger one is kept.
+	// arDetectMarker2 misses the second of two dropped candidates in a row, all of them are dropped here
+	for(size_t i=0; i<candidates.size(); i++) {
+		for(size_t j=i+1; j<candidates.size(); j++) {
+			ARFloat dx = candidates[i].pos[0] - candidates[j].pos[0];
+			ARFloat dy = candidates[i].pos[1] - candidates[j].pos[1];
+			ARFloat d = dx * dx + dy * dy;
+			if(candidates[i].area > candidates[j].area) {
+				if(d < candidates[i].area / 4) {
+					candidates[j].area = 0;
+				}
+			}
+			else if(d < candidates[j].area / 4) {
+				candidates[i].area = 0;
+			}
+		}
+	}
+	size_t numKept = 0;
+	for(size_t i=0; i<candidates.size(); i++) {
+		if(candidates[i].area != 0) {
+			candidates[numKept++] = candidates[i];
+		}
+	}
+	candidates.resize(numKept);
+
+	if(arImageProcMode == AR_IMAGE_PROC_IN_HALF) {
+		for(size_t i=0; i<candidates.size(); i++) {
+			candidates[i].area *= 4;
+			candidates[i].pos[0] *= 2;
+			candidates[i].pos[1] *= 2;
+		}
+		for(size_t i=0; i<contour.size(); i++) {
+			contour[i].x *= 2;
+			contour[i].y *= 2;
+		}
+	}
+	return candidates.size();
+}
+
+bool ofxARToolkitPlusTracker::traceContour(const int16_t *limage, int xsize, const int *label_ref, int label, const int clip[4], int area, Candidate &candidate) {
+	static const int xdir[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+	static const int ydir[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+	candidate.first = contour.size();
+	candidate.numPoints = 0;
+
+	// Start at the leftmost pixel of the top row of the label
+	int sx = clip[0];
+	int sy = clip[2];
+	const int16_t *row = &limage[sy * xsize];
+	while(sx <= clip[1] && (row[sx] <= 0 || label_ref[row[sx] - 1] != label)) {
+		sx++;
+	}
+	if(sx > clip[1]) {
+		return false;
+	}
+
+	// Follow the border until it is back at the start. Every pixel of the label can be left in 8 directions,
+	// so a walk of more steps than that is going around in circles somewhere else
+	ContourPoint start = { (int16_t)sx, (int16_t)sy };
+	contour.push_back(start);
+	int x = sx, y = sy;
+	int dir = 5;
+	for(int steps=0;; steps++) {
+		const int16_t *p = &limage[y * xsize + x];
+		dir = (dir + 5) % 8;
+		int i;
+		for(i=0; i<8; i++) {
+			if(p[ydir[dir] * xsize + xdir[dir]] > 0) {
+				break;
+			}
+			dir = (dir + 1) % 8;
+		}
+		if(i == 8 || steps > 8 * area) {
+			contour.resize(candidate.first);
+			return false;
+		}
+		x += xdir[dir];
+		y += ydir[dir];
+		if(x == sx && y == sy) {
+			break;
+		}
+		ContourPoint point = { (int16_t)x, (int16_t)y };
+		contour.push_back(point);
+	}
+
+	// Start over at the point farthest from the start, and close the contour there
+	int numPoints = contour.size() - candidate.first;
+	ContourPoint *points = &contour[candidate.first];
+	int dmax = 0, v1 = 0;
+	for(int i=1; i<numPoints; i++) {
+		int d = (points[i].x - sx) * (points[i].x - sx) + (points[i].y - sy) * (points[i].y - sy);
+		if(d > dmax) {
+			dmax = d;
+			v1 = i;
+		}
+	}
+	std::rotate(points, points + v1, points + numPoints);
+	ContourPoint first = contour[candidate.first];
+	contour.push_back(first);
+	candidate.numPoints = numPoints + 1;
+	return true;
+}
+
+bool ofxARToolkitPlusTracker::getVertex(const ContourPoint *points, int st, int ed, ARFloat thresh, int vertex[], int *vnum) {
+	ARFloat a = points[ed].y - points[st].y;
+	ARFloat b = points[st].x - points[ed].x;
+	ARFloat c = points[ed].x * points[st].y - points[ed].y * points[st].x;
+	ARFloat dmax = 0;
+	int v1 = st;
+	for(int i=st+1; i<ed; i++) {
+		ARFloat d = a * points[i].x + b * points[i].y + c;
+		if(d * d > dmax) {
+			dmax = d * d;
+			v1 = i;
+		}
+	}
+	if(dmax / (a * a + b * b) > thresh) {
+		if(!getVertex(points, st, v1, thresh, vertex, vnum) || *vnum > 5) {
+			return false;
+		}
+		vertex[(*vnum)++] = v1;
+		if(!getVertex(points, v1, ed, thresh, vertex, vnum)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ofxARToolkitPlusTracker::checkSquare(int area, ARFloat factor, Candidate &candidate) {
+	const ContourPoint *points = &contour[candidate.first];
+	int last = candidate.numPoints - 1;
+	// The first point is a corner, the opposite one is the farthest from it
+	int dmax = 0, v1 = 0;
+	for(int i=1; i<last; i++) {
+		int d = (points[i].x - points[0].x) * (points[i].x - points[0].x) + (points[i].y - points[0].y) * (points[i].y - points[0].y);
+		if(d > dmax) {
+			dmax = d;
+			v1 = i;
+		}
+	}
+
+	// One more corner on each side of the diagonal, or both on one side of it
+	ARFloat thresh = (ARFloat)(area / 0.75) * (ARFloat)0.01 * factor;
+	int wv1[10], wvnum1 = 0, wv2[10], wvnum2 = 0;
+	if(!getVertex(points, 0, v1, thresh, wv1, &wvnum1) || !getVertex(points, v1, last, thresh, wv2, &wvnum2)) {
+		return false;
+	}
+	int *vertex = candidate.vertex;
+	if(wvnum1 == 1 && wvnum2 == 1) {
+		vertex[1] = wv1[0];
+		vertex[2] = v1;
+		vertex[3] = wv2[0];
+	}
+	else if(wvnum1 > 1 && wvnum2 == 0) {
+		int v2 = v1 / 2;
+		wvnum1 = wvnum2 = 0;
+		if(!getVertex(points, 0, v2, thresh, wv1, &wvnum1) || !getVertex(points, v2, v1, thresh, wv2, &wvnum2)) {
+			return false;
+		}
+		if(wvnum1 != 1 || wvnum2 != 1) {
+			return false;
+		}
+		vertex[1] = wv1[0];
+		vertex[2] = wv2[0];
+		vertex[3] = v1;
+	}
+	else if(wvnum1 == 0 && wvnum2 > 1) {
+		int v2 = (v1 + last) / 2;
+		wvnum1 = wvnum2 = 0;
+		if(!getVertex(points, v1, v2, thresh, wv1, &wvnum1) || !getVertex(points, v2, last, thresh, wv2, &wvnum2)) {
+			return false;
+		}
+		if(wvnum1 != 1 || wvnum2 != 1) {
+			return false;
+		}
+		vertex[1] = v1;
+		vertex[2] = wv1[0];
+		vertex[3] = wv2[0];
+	}
+	else {
+		return false;
+	}
+	vertex[0] = 0;
+	vertex[4] = last;
+	return true;
+}
+
+ARToolKitPlus::ARMarkerInfo* ofxARToolkitPlusTracker::getMarkerInfo(const uint8_t *image, int threshold) {
+	int numFound = 0;
+	for(size_t i=0; i<candidates.size(); i++) {
+		const Candidate &candidate = candidates[i];
+		ARToolKitPlus::ARMarkerInfo &marker = marker_infoL[numFound];
+		marker.area = candidate.area;
+		marker.pos[0] = candidate.pos[0];
+		marker.pos[1] = candidate.pos[1];
+		if(getLine(&contour[candidate.first], candidate.vertex, marker.line, marker.vertex) < 0) {
+			continue;
+		}
+		// arGetCode takes the contour as ints
+		const ContourPoint *points = &contour[candidate.first];
+		int *contourX = frameArena.alloc<int>(candidate.numPoints);
+		int *contourY = frameArena.alloc<int>(candidate.numPoints);
+		for(int j=0; j<candidate.numPoints; j++) {
+			contourX[j] = points[j].x;
+			contourY[j] = points[j].y;
+		}
+		int vertex[5];
+		memcpy(vertex, candidate.vertex, sizeof(vertex));
+
+		// With the adaptive threshold the code is read with the mean of the pixels inside the corners
+		int codeThreshold = threshold;
+		if(usesAdaptiveThreshold()) {
+			int x0 = contourX[vertex[0]], y0 = contourY[vertex[0]], x1 = x0 + 1, y1 = y0 + 1;
+			for(int j=1; j<4; j++) {
+				x0 = std::min(x0, contourX[vertex[j]]);
+				y0 = std::min(y0, contourY[vertex[j]]);
+				x1 = std::max(x1, contourX[vertex[j]] + 1);
+				y1 = std::max(y1, contourY[vertex[j]] + 1);
+			}
+			// The candidate lies inside its region, so the integral image of that region holds its corners
+			codeThreshold = thresh;
+			for(size_t j=0; j<integralBounds.size(); j++) {
+				const Region &sums = integralBounds[j];
+				if(x0 < sums.x0 || y0 < sums.y0 || x1 > sums.x1 || y1 > sums.y1) {
+					continue;
+				}
+				int integralWidth = sums.x1 - sums.x0;
+				const uint32_t *top = &integrals[j][(y0 - sums.y0) * (integralWidth + 1)];
+				const uint32_t *bottom = &integrals[j][(y1 - sums.y0) * (integralWidth + 1)];
+				uint32_t sum = bottom[x1 - sums.x0] - bottom[x0 - sums.x0] - top[x1 - sums.x0] + top[x0 - sums.x0];
+				codeThreshold = sum / ((x1 - x0) * (y1 - y0));
+				break;
+			}
+		}
+		arGetCode(image, contourX, contourY, vertex, &marker.id, &marker.dir, &marker.cf, codeThreshold);
+		numFound++;
+	}
+	wmarker_num = numFound;
+	return marker_infoL;
+}
+
+int ofxARToolkitPlusTracker::getLine(const ContourPoint *points, const int vertex[5], ARFloat line[4][3], ARFloat v[4][2]) {
+	for(int i=0; i<4; i++) {
+		// The ends of every side are left out, they are too close to the corners
+		ARFloat w1 = (ARFloat)(vertex[i+1] - vertex[i] + 1) * (ARFloat)0.05 + (ARFloat)0.5;
+		int st = (int)(vertex[i] + w1);
+		int ed = (int)(vertex[i+1] - w1);
+		int n = ed - st + 1;
+		if(n < 2) {
+			return -1;
+		}
+		ARFloat *ideal = frameArena.alloc<ARFloat>(n * 2);
+		for(int j=0; j<n; j++) {
+			(this->*arCameraObserv2Ideal_func)(arCamera, (ARFloat)points[st+j].x, (ARFloat)points[st+j].y, &ideal[j*2], &ideal[j*2+1]);
+		}
+		fitLine(ideal, n, line[i]);
+	}
+
+	for(int i=0; i<4; i++) {
+		ARFloat *prev = line[(i+3)%4];
+		ARFloat w1 = prev[0] * line[i][1] - line[i][0] * prev[1];
+		if(w1 == 0) {
+			return -1;
+		}
+		v[i][0] = (prev[1] * line[i][2] - line[i][1] * prev[2]) / w1;
+		v[i][1] = (line[i][0] * prev[2] - prev[0] * line[i][2]) / w1;
+	}
+	return 0;
+}
+
+void ofxARToolkitPlusTracker::fitLine(const ARFloat *points, int n, ARFloat line[3]) {
+	// Covariance of the points, scaled the way arMatrixPCA does
+	ofxARToolkitPlusVector<2> mean = ofxARToolkitPlusVector<2>::zero();
+	for(int j=0; j<n; j++) {
+		mean(0, 0) += points[j*2];
+		mean(1, 0) += points[j*2+1];
+	}
+	mean(0, 0) /= n;
+	mean(1, 0) /= n;
+	ARFloat srow = sqrt((ARFloat)n);
+	ofxARToolkitPlusMatrix<2, 2> u = ofxARToolkitPlusMatrix<2, 2>::zero();
+	for(int j=0; j<n; j++) {
+		ARFloat x = (points[j*2] - mean(0, 0)) / srow;
+		ARFloat y = (points[j*2+1] - mean(1, 0)) / srow;
+		u(0, 0) += x * x;
+		u(0, 1) += x * y;
+		u(1, 1) += y * y;
+	}
+
+	// The QR iterations of arMatrixPCA for two dimensions, on the diagonal d, the off-diagonal e
+	// and the rotation a that ends up holding the eigenvectors in its rows
+	const double eps = 1e-6, vzero = 1e-16;
+	ARFloat d[2] = {u(0, 0), u(1, 1)};
+	ARFloat e = u(0, 1);
+	ofxARToolkitPlusMatrix<2, 2> a = ofxARToolkitPlusMatrix<2, 2>::identity();
+	if(fabs(e) > eps * (fabs(d[0]) + fabs(d[1]))) {
+		int iter = 0;
+		do {
+			if(++iter > 100) {
+				break;
+			}
+			ARFloat w = (d[0] - d[1]) / 2;
+			ARFloat t = e * e;
+			ARFloat s = sqrt(w * w + t);
+			if(w < 0) {
+				s = -s;
+			}
+			ARFloat x = d[0] - d[1] + t / (w + s);
+			ARFloat y = e;
+			ARFloat c;
+			if(fabs(x) >= fabs(y)) {
+				if(fabs(x) > vzero) {
+					t = -y / x;
+					c = 1 / sqrt(t * t + 1);
+					s = t * c;
+				}
+				else {
+					c = 1;
+					s = 0;
+				}
+			}
+			else {
+				t = -x / y;
+				s = 1 / sqrt(t * t + 1);
+				c = t * s;
+			}
+			w = d[0] - d[1];
+			t = (w * s + 2 * c * e) * s;
+			d[0] -= t;
+			d[1] += t;
+			e += s * (c * w - 2 * s * e);
+			ofxARToolkitPlusMatrix<2, 2> rotation = {{{c, -s}, {s, c}}};
+			a = rotation * a;
+		} while(fabs(e) > eps * (fabs(d[0]) + fabs(d[1])));
+	}
+	// The eigenvector of the larger eigenvalue is the direction of the line
+	int major = d[1] > d[0] ? 1 : 0;
+	ARFloat evec[2] = {a(major, 0), a(major, 1)};
+	if(d[major] < vzero) {
+		evec[0] = evec[1] = 0;
+	}
+	line[0] = evec[1];
+	line[1] = -evec[0];
+	line[2] = -(line[0] * mean(0, 0) + line[1] * mean(1, 0));
+}
+
+void ofxARToolkitPlusTracker::matchPreviousMarkers() {
+	// A marker about the size and place of one seen in the last frames but read with
+	// less confidence takes over its ID, and the direction that best lines up the corners
+	for(int i=0; i<prev_num; i++) {
+		const ARToolKitPlus::ARMarkerInfo &previous = prev_info[i].marker;
+		ARFloat rlenmin = 10.0;
+		int cid = -1;
+		for(int j=0; j<wmarker_num; j++) {
+			ARFloat rarea = (ARFloat)previous.area / (ARFloat)wmarker_info[j].area;
+			if(rarea < 0.7 || rarea > 1.43) {
+				continue;
+			}
+			ARFloat dx = wmarker_info[j].pos[0] - previous.pos[0];
+			ARFloat dy = wmarker_info[j].pos[1] - previous.pos[1];
+			ARFloat rlen = (dx * dx + dy * dy) / wmarker_info[j].area;
+			if(rlen < 0.5 && rlen < rlenmin) {
+				rlenmin = rlen;
+				cid = j;
+			}
+		}
+		if(cid < 0 || wmarker_info[cid].cf >= previous.cf) {
+			continue;
+		}
+		ARToolKitPlus::ARMarkerInfo &marker = wmarker_info[cid];
+		marker.cf = previous.cf;
+		marker.id = previous.id;
+		ARFloat diffmin = 10000.0 * 10000.0;
+		int cdir = -1;
+		for(int j=0; j<4; j++) {
+			ARFloat diff = 0;
+			for(int k=0; k<4; k++) {
+				ARFloat dx = previous.vertex[k][0] - marker.vertex[(j + k) % 4][0];
+				ARFloat dy = previous.vertex[k][1] - marker.vertex[(j + k) % 4][1];
+				diff += dx * dx + dy * dy;
+			}
+			if(diff < diffmin) {
+				diffmin = diff;
+				cdir = (previous.dir - j + 4) % 4;
+			}
+		}
+		marker.dir = cdir;
+	}
+
+	for(int i=0; i<wmarker_num; i++) {
+		if(wmarker_info[i].cf < 0.5) {
+			wmarker_info[i].id = -1;
+		}
+	}
+
+	// Age the history, markers not seen for 4 frames are forgotten
+	int numKept = 0;
+	for(int i=0; i<prev_num; i++) {
+		prev_info[i].count++;
+		if(prev_info[i].count < 4) {
+			prev_info[numKept++] = prev_info[i];
+		}
+	}
+	prev_num = numKept;
+
+	for(int i=0; i<wmarker_num; i++) {
+		if(wmarker_info[i].id < 0) {
+			continue;
+		}
+		int j = 0;
+		while(j < prev_num && prev_info[j].marker.id != wmarker_info[i].id) {
+			j++;
+		}
+		if(j >= MAX_IMAGE_PATTERNS) {
+			continue;
+		}
+		prev_info[j].marker = wmarker_info[i];
+		prev_info[j].count = 1;
+		if(j == prev_num) {
+			prev_num++;
+		}
+	}
+
+	// Markers from the history that were missed in this frame are still reported
+	for(int i=0; i<prev_num; i++) {
+		const ARToolKitPlus::ARMarkerInfo &previous = prev_info[i].marker;
+		int j;
+		for(j=0; j<wmarker_num; j++) {
+			ARFloat rarea = (ARFloat)previous.area / (ARFloat)wmarker_info[j].area;
+			if(rarea < 0.7 || rarea > 1.43) {
+				continue;
+			}
+			ARFloat dx = wmarker_info[j].pos[0] - previous.pos[0];
+			ARFloat dy = wmarker_info[j].pos[1] - previous.pos[1];
+			if((dx * dx + dy * dy) / wmarker_info[j].area < 0.5) {
+				break;
+			}
+		}
+		if(j == wmarker_num && wmarker_num < MAX_IMAGE_PATTERNS) {
+			wmarker_info[wmarker_num++] = previous;
+		}
+	}
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusTracker::selectScanRegions() {
+	bool fullScanDue = ++framesSinceFullScan >= fullScanInterval;
+	if(!predictiveROI || fullScanDue || fullScanPending || tracks.empty() || arImageProcMode != AR_IMAGE_PROC_IN_FULL) {
+		scanRegions = detectionROIs.empty() ? NULL : &detectionROIs;
+		framesSinceFullScan = 0;
+		fullScanPending = false;
+		numFullScanFrames++;
+		return;
+	}
+
+	predictedRegions.resize(tracks.size());
+	for(size_t i=0; i<tracks.size(); i++) {
+		// Expect the marker to keep moving the way it did, give it room to speed up or turn
+		const Track &track = tracks[i];
+		float size = std::max(track.maxX - track.minX, track.maxY - track.minY);
+		float margin = size * predictiveROIMargin + std::max(fabs(track.motionX), fabs(track.motionY)) + 2;
+		Region &region = predictedRegions[i];
+		region.x0 = floor(track.minX + track.motionX - margin);
+		region.y0 = floor(track.minY + track.motionY - margin);
+		region.x1 = ceil(track.maxX + track.motionX + margin) + 1;
+		region.y1 = ceil(track.maxY + track.motionY + margin) + 1;
+	}
+	scanRegions = &predictedRegions;
+	numROIFrames++;
+}
+
+void ofxARToolkitPlusTracker::updateTracks(int numFound) {
+	nextTracks.clear();
+	for(int i=0; i<numFound; i++) {
+		const ARToolKitPlus::ARMarkerInfo &marker = wmarker_info[i];
+		if(marker.id < 0) {
+			continue;
+		}
+		// The corners are undistorted while the windows are searched in the camera image.
+		// Distortion barely changes the size of a marker, so take the size from the corners
+		// and center it on the middle of its labels, which is in camera pixels already
+		ARFloat minX = marker.vertex[0][0], maxX = minX;
+		ARFloat minY = marker.vertex[0][1], maxY = minY;
+		for(int k=1; k<4; k++) {
+			minX = std::min(minX, marker.vertex[k][0]);
+			maxX = std::max(maxX, marker.vertex[k][0]);
+			minY = std::min(minY, marker.vertex[k][1]);
+			maxY = std::max(maxY, marker.vertex[k][1]);
+		}
+		Track track;
+		track.id = marker.id;
+		track.minX = marker.pos[0] - (maxX - minX) / 2;
+		track.maxX = marker.pos[0] + (maxX - minX) / 2;
+		track.minY = marker.pos[1] - (maxY - minY) / 2;
+		track.maxY = marker.pos[1] + (maxY - minY) / 2;
+		track.motionX = 0;
+		track.motionY = 0;
+		for(size_t j=0; j<tracks.size(); j++) {
+			if(tracks[j].id == track.id) {
+				track.motionX = (track.minX + track.maxX - tracks[j].minX - tracks[j].maxX) / 2;
+				track.motionY = (track.minY + track.maxY - tracks[j].minY - tracks[j].maxY) / 2;
+				break;
+			}
+		}
+		nextTracks.push_back(track);
+	}
+
+	// A marker missing from its window may have moved out of it, look for it everywhere next frame
+	if(scanRegions == &predictedRegions) {
+		for(size_t i=0; i<tracks.size() && !fullScanPending; i++) {
+			bool found = false;
+			for(size_t j=0; j<nextTracks.size() && !found; j++) {
+				found = nextTracks[j].id == tracks[i].id;
+			}
+			fullScanPending = !found;
+		}
+	}
+	tracks.swap(nextTracks);
+}
+
+//--------------------------------------------------
+int16_t* ofxARToolkitPlusTracker::labelImage(const uint8_t *image, int threshold, int *label_num, int **area, ARFloat **pos, int **clip, int **label_ref) {
+	if(arImageProcMode != AR_IMAGE_PROC_IN_FULL) {
+		return arLabeling(image, threshold, label_num, area, pos, clip, label_ref);
+	}
+	const vector<Region> *source = scanRegions;
+	// The predicted windows are small already, only full scans go through the pyramid
+	if(pyramidScale > 1 && scanRegions != &predictedRegions) {
+		findCoarseCandidates(image, threshold);
+		source = &candidateRegions;
+	}
+	int width = arImXsize;
+	int height = arImYsize;
+	if(source == NULL) {
+		// Only arLabeling knows how to follow the vignetting with the threshold
+		if(vignetting.enabled && !adaptiveThreshold) {
+			return arLabeling(image, threshold, label_num, area, pos, clip, label_ref);
+		}
+		Region region = { 0, 0, width, height };
+		wholeImage.assign(1, region);
+		source = &wholeImage;
+	}
+
+	mergeRegions(*source, width, height, regions);
+	labelRegions(image, width, height, threshold, adaptiveThreshold ? adaptiveHalfWindow : 0, collectHistogram ? histogram : NULL, regions);
+
+	// Only the components arDetectMarker2 would look at are passed on, in the order their first
+	// run was found as arLabeling numbers them. Every raw label points at a smaller one, so
+	// the label of the root is known by the time any other raw label of the component is reached
+	int numRaw = rawLabels.size() - 1;
+	finalLabels.assign(numRaw + 1, 0);
+	int numLabels = 0;
+	labelArea.clear();
+	labelPos.clear();
+	labelClip.clear();
+	for(int i=1; i<=numRaw; i++) {
+		const RawLabel &label = rawLabels[i];
+		if(label.parent != i) {
+			finalLabels[i] = finalLabels[label.parent];
+			continue;
+		}
+		// A component cut off by the edge of its region may be part of a bigger one
+		if(label.area < AR_AREA_MIN || label.area > AR_AREA_MAX || touchesEdge(label, regions[label.region])) {
+			continue;
+		}
+		if(numLabels == std::numeric_limits<int16_t>::max()) {
+			return NULL;
+		}
+		finalLabels[i] = ++numLabels;
+		labelArea.push_back(label.area);
+		labelPos.push_back((ARFloat)label.sumX / label.area);
+		labelPos.push_back((ARFloat)label.sumY / label.area);
+		labelClip.push_back(label.minX);
+		labelClip.push_back(label.maxX);
+		labelClip.push_back(label.minY);
+		labelClip.push_back(label.maxY);
+	}
+	labelRef.resize(numLabels);
+	for(int i=0; i<numLabels; i++) {
+		labelRef[i] = i + 1;
+	}
+
+	// arGetContour only reads the label image around the candidates, one pixel out from their
+	// clip rectangles. Those windows are cleared first as they may overlap, and then all the
+	// runs of the candidates are drawn in. The rest of the label image is never looked at
+	if((int)labels.size() != width * height) {
+		labels.assign(width * height, 0);
+	}
+	for(int i=0; i<numLabels; i++) {
+		const int *box = &labelClip[i * 4];
+		for(int y=box[2]-1; y<=box[3]+1; y++) {
+			memset(&labels[y * width + box[0] - 1], 0, (box[1] - box[0] + 3) * sizeof(int16_t));
+		}
+	}
+	for(size_t i=0; i<runs.size(); i++) {
+		const Run &run = runs[i];
+		int16_t label = finalLabels[run.label];
+		if(label > 0) {
+			std::fill(&labels[run.y * width + run.x0], &labels[run.y * width + run.x1], label);
+		}
+	}
+
+	*label_num = numLabels;
+	*area = numLabels > 0 ? &labelArea[0] : NULL;
+	*pos = numLabels > 0 ? &labelPos[0] : NULL;
+	*clip = numLabels > 0 ? &labelClip[0] : NULL;
+	*label_ref = numLabels > 0 ? &labelRef[0] : NULL;
+	return &labels[0];
+}
+
+void ofxARToolkitPlusTracker::findCoarseCandidates(const uint8_t *image, int threshold) {
+	int width = arImXsize;
+	int height = arImYsize;
+
+	// Halve the image until it is pyramidScale times smaller
+	const uint8_t *coarse = image;
+	int coarseWidth = width;
+	int coarseHeight = height;
+	for(int scale=1, level=0; scale<pyramidScale; scale*=2, level++) {
+		vector<uint8_t> &halved = pyramid[level % 2];
+		halved.resize((coarseWidth / 2) * (coarseHeight / 2));
+		ofxARToolkitPlusHalveImage(coarse, coarseWidth, coarseHeight, &halved[0]);
+		coarse = &halved[0];
+		coarseWidth /= 2;
+		coarseHeight /= 2;
+	}
+
+	// Search what a full scan would, only smaller
+	coarseSource.clear();
+	if(scanRegions == NULL) {
+		Region region = { 0, 0, coarseWidth, coarseHeight };
+		coarseSource.push_back(region);
+	}
+	else {
+		for(size_t i=0; i<scanRegions->size(); i++) {
+			const Region &full = (*scanRegions)[i];
+			Region region;
+			region.x0 = std::max(full.x0, 0) / pyramidScale;
+			region.y0 = std::max(full.y0, 0) / pyramidScale;
+			region.x1 = (std::min(full.x1, width) + pyramidScale - 1) / pyramidScale;
+			region.y1 = (std::min(full.y1, height) + pyramidScale - 1) / pyramidScale;
+			coarseSource.push_back(region);
+		}
+	}
+	mergeRegions(coarseSource, coarseWidth, coarseHeight, coarseRegions);
+
+	labelRegions(coarse, coarseWidth, coarseHeight, threshold, adaptiveThreshold ? std::max(adaptiveHalfWindow / pyramidScale, 1) : 0, NULL, coarseRegions);
+
+	// A window around every component of about marker size, with room for the
+	// partly dark pixels at its edge that the coarse image averaged away
+	candidateRegions.clear();
+	int numRaw = rawLabels.size() - 1;
+	int pixelArea = pyramidScale * pyramidScale;
+	for(int i=1; i<=numRaw; i++) {
+		const RawLabel &label = rawLabels[i];
+		if(label.parent != i || label.area * pixelArea < AR_AREA_MIN / 2 || label.area * pixelArea > AR_AREA_MAX * 2) {
+			continue;
+		}
+		const Region &region = coarseRegions[label.region];
+		if(touchesEdge(label, region)) {
+			continue;
+		}
+		Region window;
+		window.x0 = std::max(label.minX - 2, region.x0) * pyramidScale;
+		window.y0 = std::max(label.minY - 2, region.y0) * pyramidScale;
+		window.x1 = std::min(label.maxX + 3, region.x1) * pyramidScale;
+		window.y1 = std::min(label.maxY + 3, region.y1) * pyramidScale;
+		candidateRegions.push_back(window);
+	}
+}
+
+void ofxARToolkitPlusTracker::mergeRegions(const vector<Region> &source, int width, int height, vector<Region> &merged) {
+	merged.clear();
+	for(size_t i=0; i<source.size(); i++) {
+		Region region = source[i];
+		region.x0 = std::max(region.x0, 0);
+		region.y0 = std::max(region.y0, 0);
+		region.x1 = std::min(region.x1, width);
+		region.y1 = std::min(region.y1, height);
+		// Nothing inside the outermost rows and columns
+		if(region.x1 - region.x0 < 3 || region.y1 - region.y0 < 3) {
+			continue;
+		}
+		// Grow the region over every region it overlaps, those may now overlap others
+		for(size_t j=0; j<merged.size();) {
+			const Region &other = merged[j];
+			if(region.x0 < other.x1 && other.x0 < region.x1 && region.y0 < other.y1 && other.y0 < region.y1) {
+				region.x0 = std::min(region.x0, other.x0);
+				region.y0 = std::min(region.y0, other.y0);
+				region.x1 = std::max(region.x1, other.x1);
+				region.y1 = std::max(region.y1, other.y1);
+				merged.erase(merged.begin() + j);
+				j = 0;
+			}
+			else {
+				j++;
+			}
+		}
+		merged.push_back(region);
+	}
+}
+
+void ofxARToolkitPlusTracker::labelRegions(const uint8_t *image, int width, int height, int threshold, int halfWindow, unsigned int *samples, const vector<Region> &bounds) {
+	if(halfWindow > 0) {
+		// An integral image per region over the region and the windows around its pixels, so
+		// the frame between regions far apart is not summed up
+		integrals.resize(bounds.size());
+		integralBounds.resize(bounds.size());
+		for(size_t i=0; i<bounds.size(); i++) {
+			Region box;
+			box.x0 = std::max(bounds[i].x0 - halfWindow, 0);
+			box.y0 = std::max(bounds[i].y0 - halfWindow, 0);
+			box.x1 = std::min(bounds[i].x1 + halfWindow, width);
+			box.y1 = std::min(bounds[i].y1 + halfWindow, height);
+			integralBounds[i] = box;
+			integrals[i].resize((box.x1 - box.x0 + 1) * (box.y1 - box.y0 + 1));
+			ofxARToolkitPlusIntegralImage(image + box.y0 * width + box.x0, width, box.x1 - box.x0, box.y1 - box.y0, &integrals[i][0]);
+		}
+	}
+
+	// Like the image border in arLabeling, the outermost rows and columns of a region are left out
+	// so no component reaches outside of it. The inner rows of the big regions are split into a
+	// stripe per thread, the stripes are labeled on their own and joined afterwards
+	int numThreads = labelPool.getNumThreads();
+	int numStripes = 0;
+	for(size_t i=0; i<bounds.size(); i++) {
+		int numRows = bounds[i].y1 - bounds[i].y0 - 2;
+		numStripes += std::max(std::min(numThreads, numRows / minStripeRows), 1);
+	}
+	if((int)stripes.size() < numStripes) {
+		stripes.resize(numStripes);
+	}
+	for(size_t i=0, stripe=0; i<bounds.size(); i++) {
+		int numRows = bounds[i].y1 - bounds[i].y0 - 2;
+		int parts = std::max(std::min(numThreads, numRows / minStripeRows), 1);
+		for(int part=0; part<parts; part++, stripe++) {
+			stripes[stripe].region = i;
+			stripes[stripe].y0 = bounds[i].y0 + 1 + numRows * part / parts;
+			stripes[stripe].y1 = bounds[i].y0 + 1 + numRows * (part + 1) / parts;
+		}
+	}
+	// Few enough captures for std::function to keep the job without allocating
+	struct StripeJob {
+		const uint8_t *image;
+		int width, threshold, halfWindow;
+		bool sample;
+		const vector<Region> *bounds;
+	} job = { image, width, threshold, halfWindow, samples != NULL, &bounds };
+	labelPool.run(numStripes, [this, &job](int i) {
+		labelStripe(job.image, job.width, job.threshold, job.halfWindow, job.sample, *job.bounds, stripes[i]);
+	});
+
+	// Raw labels start at 1, the first entry is unused. The raw labels of each stripe come after the
+	// ones of the stripes above, so they are still numbered in the order their first run was found
+	rawLabels.resize(1);
+	runs.clear();
+	size_t lastRow = 0;
+	for(int i=0; i<numStripes; i++) {
+		const Stripe &stripe = stripes[i];
+		int offset = rawLabels.size() - 1;
+		size_t firstRun = runs.size();
+		for(size_t j=1; j<stripe.rawLabels.size(); j++) {
+			rawLabels.push_back(stripe.rawLabels[j]);
+			rawLabels.back().parent += offset;
+		}
+		for(size_t j=0; j<stripe.runs.size(); j++) {
+			runs.push_back(stripe.runs[j]);
+			runs.back().label += offset;
+		}
+		if(samples) {
+			for(int j=0; j<256; j++) {
+				samples[j] += stripe.histogram[j];
+			}
+		}
+		// Join the components running over from the stripe above
+		if(i > 0 && stripes[i - 1].region == stripe.region) {
+			size_t firstRowEnd = firstRun;
+			while(firstRowEnd < runs.size() && runs[firstRowEnd].y == stripe.y0) {
+				firstRowEnd++;
+			}
+			size_t above = lastRow;
+			for(size_t j=firstRun; j<firstRowEnd; j++) {
+				while(above < firstRun && runs[above].x1 < runs[j].x0) {
+					above++;
+				}
+				for(size_t k=above; k<firstRun && runs[k].x0 <= runs[j].x1; k++) {
+					mergeLabels(rawLabels, runs[j].label, runs[k].label);
+				}
+			}
+		}
+		lastRow = runs.size();
+		while(lastRow > firstRun && runs[lastRow - 1].y == stripe.y1 - 1) {
+			lastRow--;
+		}
+	}
+
+	// Sum up the statistics into the roots, children before their parents
+	for(int i=rawLabels.size()-1; i>=1; i--) {
+		RawLabel &label = rawLabels[i];
+		if(label.parent == i) {
+			continue;
+		}
+		RawLabel &parent = rawLabels[label.parent];
+		parent.area += label.area;
+		parent.sumX += label.sumX;
+		parent.sumY += label.sumY;
+		parent.minX = std::min(parent.minX, label.minX);
+		parent.maxX = std::max(parent.maxX, label.maxX);
+		parent.minY = std::min(parent.minY, label.minY);
+		parent.maxY = std::max(parent.maxY, label.maxY);
+	}
+}
+
+void ofxARToolkitPlusTracker::labelStripe(const uint8_t *image, int width, int threshold, int halfWindow, bool sample, const vector<Region> &bounds, Stripe &stripe) {
+	const Region &box = bounds[stripe.region];
+	int first = box.x0 + 1;
+	int numInner = box.x1 - box.x0 - 2;
+	stripe.rawLabels.resize(1);
+	stripe.runs.clear();
+	stripe.darkMask.resize(width / 64 + 1);
+	if(sample) {
+		memset(stripe.histogram, 0, sizeof(stripe.histogram));
+	}
+	size_t above = 0, aboveEnd = 0;
+	for(int y=stripe.y0; y<stripe.y1; y++) {
+		size_t rowStart = stripe.runs.size();
+
+		// Dark pixels as bits, bit 0 is the first inner column. A run that reaches the
+		// end of a word is closed in the next one
+		const uint8_t *row = image + y * width + first;
+		uint64_t *mask = &stripe.darkMask[0];
+		if(halfWindow > 0) {
+			const Region &sums = integralBounds[stripe.region];
+			const vector<uint32_t> &integral = integrals[stripe.region];
+			int integralWidth = sums.x1 - sums.x0;
+			int top = std::max(y - halfWindow, sums.y0) - sums.y0;
+			int bottom = std::min(y + halfWindow + 1, sums.y1) - sums.y0;
+			ofxARToolkitPlusLocalThresholdMask(row, &integral[top * (integralWidth + 1)], &integral[bottom * (integralWidth + 1)], integralWidth, bottom - top,
+				first - sums.x0, numInner, halfWindow, adaptiveOffset, mask);
+		}
+		else {
+			ofxARToolkitPlusThresholdMask(row, numInner, threshold, mask);
+		}
+		if(sample && (y - box.y0 - 1) % histogramStep == 0) {
+			ofxARToolkitPlusAddToHistogram(row, numInner, histogramStep, stripe.histogram);
+		}
+		int runStart = -1;
+		for(int word=0; word * 64 < numInner; word++) {
+			uint64_t bits = mask[word];
+			int bit = 0;
+			while(bit < 64) {
+				if(runStart < 0) {
+					uint64_t dark = bits >> bit;
+					if(dark == 0) {
+						break;
+					}
+					bit += countTrailingZeros(dark);
+					runStart = word * 64 + bit;
+				}
+				uint64_t light = ~bits >> bit;
+				if(light == 0) {
+					break;
+				}
+				bit += countTrailingZeros(light);
+				addRun(stripe, y, first + runStart, first + word * 64 + bit, above, aboveEnd);
+				runStart = -1;
+			}
+		}
+		if(runStart >= 0) {
+			addRun(stripe, y, first + runStart, first + numInner, above, aboveEnd);
+		}
+
+		above = rowStart;
+		aboveEnd = stripe.runs.size();
+	}
+}
+
+void ofxARToolkitPlusTracker::addRun(Stripe &stripe, int y, int x0, int x1, size_t &above, size_t aboveEnd) {
+	vector<Run> &runs = stripe.runs;
+	vector<RawLabel> &rawLabels = stripe.rawLabels;
+	// 8-connected: the run joins every run of the row above that overlaps it
+	// or ends or starts diagonally next to it
+	while(above < aboveEnd && runs[above].x1 < x0) {
+		above++;
+	}
+	int label = 0;
+	for(size_t i=above; i<aboveEnd && runs[i].x0 <= x1; i++) {
+		if(label == 0) {
+			label = runs[i].label;
+		}
+		else {
+			mergeLabels(rawLabels, label, runs[i].label);
+		}
+	}
+	if(label == 0) {
+		label = rawLabels.size();
+		RawLabel raw = { label, stripe.region, 0, 0, 0, x0, x1 - 1, y, y };
+		rawLabels.push_back(raw);
+	}
+	Run run = { y, x0, x1, label };
+	runs.push_back(run);
+
+	int length = x1 - x0;
+	RawLabel &raw = rawLabels[label];
+	raw.area += length;
+	raw.sumX += (long long)(x0 + x1 - 1) * length / 2;
+	raw.sumY += (long long)y * length;
+	raw.minX = std::min(raw.minX, x0);
+	raw.maxX = std::max(raw.maxX, x1 - 1);
+	raw.maxY = y;
+}
+
+bool ofxARToolkitPlusTracker::touchesEdge(const RawLabel &label, const Region &region) {
+	return label.minX <= region.x0 + 1 || label.maxX >= region.x1 - 2 || label.minY <= region.y0 + 1 || label.maxY >= region.y1 - 2;
+}
+
+int ofxARToolkitPlusTracker::findRoot(vector<RawLabel> &labels, int label) {
+	while(labels[label].parent != label) {
+		// Path halving keeps the chains short
+		int parent = labels[label].parent;
+		labels[label].parent = labels[parent].parent;
+		label = parent;
+	}
+	return label;
+}
+
+void ofxARToolkitPlusTracker::mergeLabels(vector<RawLabel> &labels, int a, int b) {
+	a = findRoot(labels, a);
+	b = findRoot(labels, b);
+	// The smaller label becomes the root, so parents always come before their children
+	if(a < b) {
+		labels[b].parent = a;
+	}
+	else if(b < a) {
+		labels[a].parent = b;
+	}
+}
@@ -0,0 +1,332 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ARToolKitPlus/TrackerMultiMarker.h"
+
+#include "ofxARToolkitPlusWorkerPool.h"
+#include "ofxARToolkitPlusFrameArena.h"
+#include "ofxARToolkitPlusMatrix.h"
+
+/*
+ * The multi-marker tracker used by ofxARToolkitPlus, with its own labeling stage.
+ * The labeling in ARToolKitPlus (arLabeling) always runs over the whole frame and can not
+ * be replaced on its own, so arDetectMarker() and arDetectMarkerLite() are overridden with
+ * the same steps as the library, only calling labelImage() for the labels and findCandidates() and getLine() for
+ * the contours and lines. Marker codes, undistortion and poses are still done by the library.
+ *
+ * Labeling works on horizontal runs of dark pixels: every row is thresholded into a bitmask
+ * (SIMD where available), its runs are joined with the overlapping runs of the row above, and
+ * area, center and bounds are summed up per run. Only the components that can be markers are
+ * drawn into the label image, and only around themselves, where the library traces their contours.
+ * arLabeling is only used for IMAGE_HALF_RES and with vignetting compensation.
+ * With more than one label thread, big regions are split into horizontal stripes that are labeled
+ * at the same time and joined at the seams, which gives exactly the same labels as one thread.
+ *
+ * With the adaptive threshold every pixel is compared with the mean of a window around it instead,
+ * looked up in an integral image of each labeled region. The marker codes are then read one candidate at
+ * a time, each with the mean of its own pixels as the threshold.
+ *
+ * Labeling can be restricted to a few rectangles of the image. Pixels outside them are never
+ * read, and marker candidates that touch the edge of a rectangle are dropped just like the ones
+ * touching the edge of the image, so the cost of a frame scales with the area of the rectangles.
+ * The rectangles are labeled with the plain threshold (no vignetting compensation) and only in
+ * IMAGE_FULL_RES mode, in IMAGE_HALF_RES the whole image is searched.
+ *
+ * In predictive ROI mode the rectangles follow the markers: once markers have been found, the
+ * next frame only searches a window around where each of them is expected, from its corners and
+ * its motion over the last frame. A full scan picks up new markers every few frames and right
+ * after a marker was lost.
+ *
+ * With a pyramid scale, full scans are done coarse to fine: the image is shrunk by 2 or 4 and
+ * labeled first, and only windows around the components of about marker size are labeled again
+ * at full resolution. Contours, corners and codes are always found at full resolution.
+ *
+ * Contours are traced like arDetectMarker2 does, but kept as 16 bit points one after the other
+ * instead of in ARMarkerInfo2, which holds 2 * AR_CHAIN_MAX ints for every candidate whatever its
+ * size, and gives up on contours longer than that. The library's array of them is never touched.
+ * The lines of the sides are fitted like arGetLine does, but on fixed size 2x2 matrices instead of
+ * matrices allocated for every side, with the undistorted points taken from a frame arena that
+ * allocates nothing once the frames stop growing. Only arGetCode still allocates per candidate.
+ *
+ * Corner refinement moves the corners of every candidate to sub-pixel accuracy on the image
+ * gradients before the history and the pose estimation see them. The line fits
+ * only see the integer contour, and only every other pixel of it in IMAGE_HALF_RES mode.
+ */
+class ofxARToolkitPlusTracker : public ARToolKitPlus::TrackerMultiMarker {
+
+	public:
+
+	/* How auto threshold picks the threshold */
+	enum AutoThresholdMethod {
+		/* ARToolKitPlus' own: halfway between the darkest and the brightest pixel of the markers found,
+		 * and random thresholds for up to the number of auto threshold retries if none were */
+		AUTO_THRESHOLD_RANDOM,
+		/* From a histogram of the labeled pixels, or of the pixels around the markers found,
+		 * with Otsu's method or at the valley between its two peaks. A frame without markers
+		 * is searched once more, with the threshold of the pixels it labeled */
+		AUTO_THRESHOLD_OTSU,
+		AUTO_THRESHOLD_BIMODAL
+	};
+
+	ofxARToolkitPlusTracker(int width, int height, int maxImagePatterns = 8, int pattWidth = 6, int pattHeight = 6, int pattSamples = 6, int maxLoadPatterns = 0);
+
+	/* Only look for markers inside these rectangles (in image pixels) from the next frame on.
+	 * Overlapping rectangles are merged, parts outside the image are cut off.
+	 * No rectangles (the default) searches the whole image */
+	void setDetectionROIs(const ofRectangle *rois, int count);
+	/* Number of rectangles set - 0 if the whole image is searched */
+	int getNumDetectionROIs() const;
+
+	/* Search only the predicted windows around the markers of the last frame. Full scans search
+	 * the detection ROIs if set, or the whole image. The windows are not limited to the detection ROIs */
+	void activatePredictiveROI(bool state);
+	bool isPredictiveROIActivated() const;
+	/* Do a full scan at least every this many frames in predictive ROI mode. Default is 30 */
+	void setFullScanInterval(int frames);
+	/* Margin around the predicted position of a marker, as a fraction of its size. Default is 0.5.
+	 * The distance the marker moved over the last frame is added on top */
+	void setPredictiveROIMargin(float fraction);
+	/* Find the candidates of full scans in the image shrunk by this factor (2 or 4) first.
+	 * Default is 1, which labels the full resolution image directly */
+	void setPyramidScale(int scale);
+	int getPyramidScale() const;
+	/* Refine the corners on the image gradients in a window of at most 2 * halfWindow + 1 pixels
+	 * (up to 16), kept inside the black border of the marker */
+	void activateCornerRefinement(bool state, int halfWindow = 4);
+	bool isCornerRefinementActivated() const;
+	/* Time in microseconds the corner refinement of the last frame took, and how many corners it moved */
+	unsigned long long getLastCornerRefineMicros() const;
+	int getNumRefinedCorners() const;
+	/* Compare every pixel with the mean of the (2 * halfWindow + 1) pixels square window around it
+	 * instead of the threshold: it is dark if it is more than offset below the mean. Only in IMAGE_FULL_RES
+	 * mode, where it replaces vignetting compensation and auto threshold retries. The black border of the
+	 * markers should not be much wider than halfWindow, or it is cut off from the pattern inside */
+	void activateAdaptiveThreshold(bool state, int halfWindow = 32, int offset = 7);
+	bool isAdaptiveThresholdActivated() const;
+	/* Default is AUTO_THRESHOLD_RANDOM. With aroundMarkers, the histogram for the threshold of the next frame
+	 * only counts the pixels around the markers found, as long as there are any */
+	void setAutoThresholdMethod(AutoThresholdMethod method, bool aroundMarkers = true);
+	AutoThresholdMethod getAutoThresholdMethod() const;
+	/* Same as in ARToolKitPlus, which caps the retries at 1 where it means to keep them at 1 or more */
+	virtual void setNumAutoThresholdRetries(int numRetries);
+	/* Detection passes of the last frame, and of all frames since the last reset, that were repeated
+	 * with another threshold because auto threshold found nothing */
+	int getLastThresholdRetries() const;
+	unsigned int getNumThresholdRetries() const;
+	void resetThresholdRetries();
+	/* Frames that searched the predicted windows only, and frames that did a full scan */
+	unsigned int getNumROIFrames() const;
+	unsigned int getNumFullScanFrames() const;
+	void resetScanCounters();
+	/* Label on this many threads, the calling one included. Default is 1 */
+	void setNumLabelThreads(int numThreads);
+	int getNumLabelThreads() const;
+	/* Time in microseconds labelImage() took in the last frame, for all of its passes */
+	unsigned long long getLastLabelMicros() const;
+	/* Time in microseconds calc() spent solving the multi-marker pose in the last frame, inside the library lock */
+	unsigned long long getLastMultiMarkerPoseMicros() const;
+	/* Scratch memory of the frame being detected. Its block allocations stop once the frames stop growing */
+	const ofxARToolkitPlusFrameArena& getFrameArena() const;
+	/* The prebuilt library keeps RPP's scratch matrices and the camera size in statics shared by
+	 * all trackers. Hold this lock around every call that can reach RPP and while setting up a tracker */
+	static std::mutex& getLibraryMutex();
+
+	virtual int calc(const uint8_t *nImage);
+	virtual int arDetectMarker(const uint8_t *dataPtr, int threshold, ARToolKitPlus::ARMarkerInfo **marker_info, int *marker_num);
+	virtual int arDetectMarkerLite(const uint8_t *dataPtr, int threshold, ARToolKitPlus::ARMarkerInfo **marker_info, int *marker_num);
+	/* Same as the library's, holding the library lock as calc() solves the multi-marker pose with RPP */
+	virtual ARFloat executeMultiMarkerPoseEstimator(ARToolKitPlus::ARMarkerInfo *marker_info, int marker_num, ARToolKitPlus::ARMultiMarkerInfoT *config);
+
+protected:
+	/* Size the buffer arLabeling() labels into for this tracker's image. checkImageBuffer() sizes it
+	 * from the camera size static, which is the size of whichever tracker was set up last */
+	void checkLabelBuffer();
+
+	/* Pixel bounds of a region, end exclusive. Its outermost rows and columns are never labeled */
+	struct Region {
+		int x0, y0, x1, y1;
+	};
+	/* A run of dark pixels in row y, end exclusive */
+	struct Run {
+		int y, x0, x1;
+		int label;
+	};
+	/* A point of a contour, in pixels of the label image */
+	struct ContourPoint {
+		int16_t x, y;
+	};
+	/* A marker candidate: numPoints points of contour from first on, starting at the point farthest from
+	 * where the contour was found and repeating it at the end. The vertices are indices into these points */
+	struct Candidate {
+		int area;
+		ARFloat pos[2];
+		int first, numPoints;
+		int vertex[5];
+	};
+	/* Statistics of a raw label. parent is smaller than the label itself for all but the roots */
+	struct RawLabel {
+		int parent;
+		int region;
+		int area;
+		long long sumX, sumY;
+		int minX, maxX, minY, maxY;
+	};
+
+	/* Label, find the candidates and read their codes, retrying with random thresholds if
+	 * auto threshold is on and nothing was found. Returns false if any of the stages failed */
+	bool detectCandidates(const uint8_t *dataPtr, int threshold);
+	/* Refine the corners of the candidates found in this frame */
+	void refineCorners(const uint8_t *image);
+	/* Set thresh for the next frame from the markers found in this one */
+	void updateAutoThreshold(const uint8_t *image);
+	/* Whether auto threshold is on with a histogram method */
+	bool usesHistogramThreshold() const;
+	/* Threshold of the histogram, sampled from the regions searched this frame if it is empty */
+	int pickHistogramThreshold(const uint8_t *image);
+	/* Whether the adaptive threshold is on and this frame is labeled with it */
+	bool usesAdaptiveThreshold() const;
+	/* Same as arDetectMarker2, finding the candidates and their contours on the labels of labelImage().
+	 * Returns the number of candidates */
+	int findCandidates(const int16_t *limage, int label_num, const int *label_ref, const int *warea, const ARFloat *wpos, const int *wclip, int area_max, int area_min, ARFloat factor);
+	/* Same as arGetContour, appending the contour of a label of the xsize pixels wide label image to contour.
+	 * Returns false and leaves contour as it was if the label is not found */
+	bool traceContour(const int16_t *limage, int xsize, const int *label_ref, int label, const int clip[4], int area, Candidate &candidate);
+	/* The point between st and ed farthest from the line through them is a vertex if it is far enough, and so
+	 * are the ones found the same way on either side of it. Fails on more than 6 */
+	static bool getVertex(const ContourPoint *points, int st, int ed, ARFloat thresh, int vertex[], int *vnum);
+	/* Same as check_square, finding the corners of the contour of a candidate */
+	bool checkSquare(int area, ARFloat factor, Candidate &candidate);
+	/* Same as arGetMarkerInfo on the candidates, reading the codes with threshold, or with the mean of
+	 * the pixels of every candidate with the adaptive threshold */
+	ARToolKitPlus::ARMarkerInfo* getMarkerInfo(const uint8_t *image, int threshold);
+	/* Same as arGetLine on the contour points of a candidate, with the undistorted points of its sides in the
+	 * frame arena instead of matrices allocated for every side */
+	int getLine(const ContourPoint *points, const int vertex[5], ARFloat line[4][3], ARFloat v[4][2]);
+	/* Same as the line arGetLine fits with arMatrixPCA through n undistorted points (x and y after each other) */
+	static void fitLine(const ARFloat *points, int n, ARFloat line[3]);
+	/* Carry the IDs of markers seen in the last frames over to the new markers (ARToolKit's marker history) */
+	void matchPreviousMarkers();
+	/* Pick the regions to search this frame: the predicted windows or a full scan */
+	void selectScanRegions();
+	/* Follow the first numFound markers of this frame for the next prediction */
+	void updateTracks(int numFound);
+
+	/* Same output as arLabeling() for the components arDetectMarker2() looks at: the label image
+	 * in full image coordinates, valid one pixel around each component, label_ref mapping the
+	 * labels in it to the final ones, and area, center and clip rectangle per final label */
+	int16_t* labelImage(const uint8_t *image, int threshold, int *label_num, int **area, ARFloat **pos, int **clip, int **label_ref);
+	/* Label the shrunk image and put a full resolution window around every candidate into candidateRegions */
+	void findCoarseCandidates(const uint8_t *image, int threshold);
+	/* Clip the source regions to an image of width x height and merge the overlapping ones */
+	void mergeRegions(const vector<Region> &source, int width, int height, vector<Region> &merged);
+	/* Find the runs of dark pixels of an image of this size inside the bounds, label them into
+	 * runs and rawLabels and sum up the statistics of every component in its root.
+	 * A halfWindow above 0 uses the adaptive threshold with windows of that size instead of threshold.
+	 * Some of the labeled pixels are counted into samples, unless it is NULL */
+	void labelRegions(const uint8_t *image, int width, int height, int threshold, int halfWindow, unsigned int *samples, const vector<Region> &bounds);
+	/* Rows y0 to y1 (exclusive) of a region, labeled on their own into runs and raw labels of the stripe */
+	struct Stripe {
+		int region;
+		int y0, y1;
+		vector<Run> runs;
+		vector<RawLabel> rawLabels;
+		/* Dark pixels of the row being labeled, one bit each */
+		vector<uint64_t> darkMask;
+		unsigned int histogram[256];
+	};
+	/* Label the rows of a stripe, counting some of its pixels into its histogram if sample is set.
+	 * Safe to call for different stripes at the same time */
+	void labelStripe(const uint8_t *image, int width, int threshold, int halfWindow, bool sample, const vector<Region> &bounds, Stripe &stripe);
+	/* Label a new run from x0 to x1 (exclusive) in row y of a stripe. The runs of the row above are
+	 * above to aboveEnd, above is moved past the ones left of the run */
+	static void addRun(Stripe &stripe, int y, int x0, int x1, size_t &above, size_t aboveEnd);
+	/* Whether a component reaches the outermost labeled pixels of its region */
+	bool touchesEdge(const RawLabel &label, const Region &region);
+	/* Root of a raw label */
+	static int findRoot(vector<RawLabel> &labels, int label);
+	/* Join the components of two raw labels */
+	static void mergeLabels(vector<RawLabel> &labels, int a, int b);
+
+	/* Detection ROIs rounded out to whole pixels, and the regions labeled this frame */
+	vector<Region> detectionROIs;
+	/* Windows around the tracked markers for this frame */
+	vector<Region> predictedRegions;
+	/* Rectangles searched this frame, NULL for the whole image */
+	const vector<Region> *scanRegions;
+	vector<Region> regions;
+	/* The whole image as a region, for full scans */
+	vector<Region> wholeImage;
+
+	/* Label image (full image size, only valid around the components labelImage() returned) */
+	vector<int16_t> labels;
+	/* Stripes of the last labelRegions() call and the threads labeling them */
+	vector<Stripe> stripes;
+	ofxARToolkitPlusWorkerPool labelPool;
+	unsigned long long lastLabelMicros;
+	unsigned long long lastMultiMarkerPoseMicros;
+	/* Runs of all rows of all regions, row by row */
+	vector<Run> runs;
+	/* Raw label statistics, 1 based like the raw labels */
+	vector<RawLabel> rawLabels;
+	/* Final label of every raw label, 0 if it is not passed on */
+	vector<int> finalLabels;
+	/* Per final label, as returned by labelImage() */
+	vector<int> labelRef;
+	vector<int> labelArea;
+	vector<ARFloat> labelPos;
+	vector<int> labelClip;
+
+	/* A marker found in the last frame: its bounds in the camera image and how far it moved since the frame before */
+	struct Track {
+		int id;
+		float minX, minY, maxX, maxY;
+		float motionX, motionY;
+	};
+	vector<Track> tracks;
+	vector<Track> nextTracks;
+	bool predictiveROI;
+	int fullScanInterval;
+	float predictiveROIMargin;
+	int framesSinceFullScan;
+	/* Set when the last frame lost a marker */
+	bool fullScanPending;
+	unsigned int numROIFrames;
+	unsigned int numFullScanFrames;
+
+	/* Coarse to fine full scans: the halved images, the regions labeled in the smallest one
+	 * and the full resolution windows around its candidates */
+	int pyramidScale;
+	vector<uint8_t> pyramid[2];
+	vector<Region> coarseSource;
+	vector<Region> coarseRegions;
+	vector<Region> candidateRegions;
+
+	bool cornerRefinement;
+	int cornerHalfWindow;
+	unsigned long long lastCornerRefineMicros;
+	int numRefinedCorners;
+
+	/* Adaptive threshold: the integral images of the last labelRegions() call, one per region over its integralBounds */
+	bool adaptiveThreshold;
+	int adaptiveHalfWindow;
+	int adaptiveOffset;
+	vector< vector<uint32_t> > integrals;
+	vector<Region> integralBounds;
+
+	/* Candidates of the last detection pass and the points of all of their contours */
+	vector<Candidate> candidates;
+	vector<ContourPoint> contour;
+	/* Temporaries of the frame being detected, taken back at the start of the next one */
+	ofxARToolkitPlusFrameArena frameArena;
+
+	/* Histogram auto threshold: the gray values counted while labeling (when collectHistogram is set)
+	 * or around the markers found */
+	AutoThresholdMethod autoThresholdMethod;
+	bool histogramAroundMarkers;
+	bool collectHistogram;
+	unsigned int histogram[256];
+	int lastThresholdRetries;
+	unsigned int numThresholdRetries;
+
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+
+/*
+ * Lock-free single producer, single consumer triple buffer.
+ * The writer fills its back buffer and publishes it, the reader picks up
+ * the newest published buffer. Neither side ever waits for the other:
+ * a buffer the reader has not picked up yet is simply replaced by the next one.
+ */
+template<class T>
+class ofxARToolkitPlusTripleBuffer {
+
+	public:
+
+	ofxARToolkitPlusTripleBuffer() {
+		writeIndex = 0;
+		middle = 1;
+		readIndex = 2;
+	}
+
+	/* Buffer the writer fills before calling publish() */
+	T& getWriteBuffer() {
+		return buffers[writeIndex];
+	}
+	/* Hand the write buffer over to the reader and take the spare one in its place */
+	void publish() {
+		writeIndex = middle.exchange(writeIndex | NEW_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	/* Pick up the newest published buffer if there is one - returns true if the read buffer changed */
+	bool acquire() {
+		if((middle.load(std::memory_order_relaxed) & NEW_BIT) == 0) {
+			return false;
+		}
+		readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+	/* Buffer picked up by the last acquire(). It is not touched by the writer until the next acquire() */
+	const T& getReadBuffer() const {
+		return buffers[readIndex];
+	}
+
+	/* Direct access to all three buffers, only for setting them up before the writer starts */
+	T& operator[](int i) {
+		return buffers[i];
+	}
+
+protected:
+	static const int INDEX_MASK = 3;
+	static const int NEW_BIT = 4;
+
+	T buffers[3];
+	/* Owned by the writer */
+	int writeIndex;
+	/* The spare buffer, with NEW_BIT set if the writer published it after the last acquire() */
+	std::atomic<int> middle;
+	/* Owned by the reader */
+	int readIndex;
+
+};
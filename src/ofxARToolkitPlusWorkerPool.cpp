@@ -0,0 +1,95 @@
+#include "ofxARToolkitPlusWorkerPool.h"
+
+
+ofxARToolkitPlusWorkerPool::ofxARToolkitPlusWorkerPool() {
+	job = NULL;
+	count = 0;
+	next = 0;
+	active = 0;
+	generation = 0;
+	quit = false;
+}
+
+ofxARToolkitPlusWorkerPool::~ofxARToolkitPlusWorkerPool() {
+	stop();
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusWorkerPool::setup(int numThreads) {
+	stop();
+	quit = false;
+	// Jobs that ran before the workers were started are not theirs
+	for(int i=1; i<numThreads; i++) {
+		workers.push_back(std::thread(&ofxARToolkitPlusWorkerPool::workerLoop, this, generation));
+	}
+}
+
+int ofxARToolkitPlusWorkerPool::getNumThreads() const {
+	return workers.size() + 1;
+}
+
+void ofxARToolkitPlusWorkerPool::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for(size_t i=0; i<workers.size(); i++) {
+		workers[i].join();
+	}
+	workers.clear();
+}
+
+//--------------------------------------------------
+void ofxARToolkitPlusWorkerPool::run(int n, const std::function<void(int)> &j) {
+	// Not worth waking anyone up
+	if(workers.empty() || n <= 1) {
+		for(int i=0; i<n; i++) {
+			j(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &j;
+		count = n;
+		next = 0;
+		active = workers.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	work();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this] { return active == 0; });
+	job = NULL;
+}
+
+void ofxARToolkitPlusWorkerPool::workerLoop(unsigned int seen) {
+	while(true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, &seen] { return quit || generation != seen; });
+			if(quit) {
+				return;
+			}
+			seen = generation;
+		}
+
+		work();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		active--;
+		if(active == 0) {
+			done.notify_one();
+		}
+	}
+}
+
+void ofxARToolkitPlusWorkerPool::work() {
+	for(int i = next++; i < count; i = next++) {
+		(*job)(i);
+	}
+}
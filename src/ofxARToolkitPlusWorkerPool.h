@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/*
+ * A small pool of persistent worker threads used to spread independent
+ * per-item jobs (e.g. one pose solve per marker) over several cores.
+ * The thread calling run() works on the job as well, so a pool set up
+ * with N threads starts N-1 workers.
+ */
+class ofxARToolkitPlusWorkerPool {
+
+	public:
+
+	ofxARToolkitPlusWorkerPool();
+	~ofxARToolkitPlusWorkerPool();
+
+	/* Use numThreads threads in total (including the caller). 1 runs everything on the calling thread */
+	void setup(int numThreads);
+	/* Return the number of threads jobs are spread over */
+	int getNumThreads() const;
+
+	/* Call job(i) for every i in [0, count) and return once all calls have finished.
+	 * Indices are handed out dynamically, so job(i) must only write to storage owned by index i */
+	void run(int count, const std::function<void(int)> &job);
+
+protected:
+	void stop();
+	/* seen is the last job generation the worker should not run */
+	void workerLoop(unsigned int seen);
+	/* Take indices from the current job until none are left */
+	void work();
+
+	vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	const std::function<void(int)> *job;
+	int count;
+	std::atomic<int> next;
+	/* Workers that have not yet finished the current job */
+	int active;
+	/* Incremented for every job so sleeping workers can tell a new one apart from a spurious wakeup */
+	unsigned int generation;
+	bool quit;
+
+};
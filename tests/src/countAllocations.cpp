@@ -0,0 +1,116 @@
+#include "testUtils.h"
+
+#include <stdlib.h>
+#include <errno.h>
+#include <atomic>
+#include <new>
+
+// Replaces every way to get memory from the heap, so the tests can see what a frame allocates.
+// Only linked into the tests: the addon itself never replaces the allocator
+
+static std::atomic<unsigned long long> numHeapAllocations(0);
+
+unsigned long long getNumHeapAllocations() {
+	return numHeapAllocations;
+}
+
+#ifdef __GLIBC__
+// operator new, the C code of ARToolKitPlus and glibc itself all call these
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void *p, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void* __libc_valloc(size_t size);
+extern "C" void* __libc_pvalloc(size_t size);
+
+extern "C" void* malloc(size_t size) {
+	numHeapAllocations++;
+	return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+	numHeapAllocations++;
+	return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void *p, size_t size) {
+	// Shrinking to nothing frees, everything else may move to a new allocation
+	if(p == NULL || size > 0) {
+		numHeapAllocations++;
+	}
+	return __libc_realloc(p, size);
+}
+
+extern "C" void* memalign(size_t alignment, size_t size) {
+	numHeapAllocations++;
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) {
+	numHeapAllocations++;
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **p, size_t alignment, size_t size) {
+	if(alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+		return EINVAL;
+	}
+	numHeapAllocations++;
+	void *memory = __libc_memalign(alignment, size);
+	if(memory == NULL) {
+		return ENOMEM;
+	}
+	*p = memory;
+	return 0;
+}
+
+extern "C" void* valloc(size_t size) {
+	numHeapAllocations++;
+	return __libc_valloc(size);
+}
+
+extern "C" void* pvalloc(size_t size) {
+	numHeapAllocations++;
+	return __libc_pvalloc(size);
+}
+#else
+// Without glibc only what goes through operator new is counted, which is all of the addon
+// and the C++ parts of ARToolKitPlus
+void* operator new(size_t size) {
+	numHeapAllocations++;
+	void *p = malloc(size ? size : 1);
+	if(p == NULL) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	numHeapAllocations++;
+	return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t&) noexcept {
+	free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t&) noexcept {
+	free(p);
+}
+#endif
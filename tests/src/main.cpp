@@ -0,0 +1,37 @@
+#include "ofMain.h"
+#include "tests.h"
+#include "testUtils.h"
+
+//========================================================================
+// Runs without a window: most tests compare ofxARToolkitPlusTracker with the library
+// on synthetic frames. Returns the number of failed checks, so 0 means all passed
+int main( ){
+
+	ofSetLogLevel(OF_LOG_NOTICE);
+
+	testDetectionROI();
+	testPredictiveROI();
+	testPyramid();
+	testCornerRefinement();
+	testThresholdMask();
+	testLabeling();
+	testAdaptiveThreshold();
+	testAutoThreshold();
+	testStripeLabeling();
+	testContours();
+	testFrameArena();
+	testHomography();
+	testOverlayMesh();
+	testAsync();
+	testMultiCamera();
+	testPoseCache();
+	testComputeAllPoses();
+	testWarmStart();
+	testMarkerIndex();
+	testMarkerCorners();
+	testColorInput();
+	testInputImage();
+
+	ofLog(OF_LOG_NOTICE, ofToString(getNumTestChecks() - getNumTestFailures()) + " of " + ofToString(getNumTestChecks()) + " checks passed");
+	return getNumTestFailures();
+}
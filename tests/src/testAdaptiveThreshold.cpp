@@ -0,0 +1,189 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+static void testIntegralImage() {
+	// Rows padded past the width, which must not be summed
+	const int w = 53;
+	const int h = 21;
+	const int stride = 64;
+	vector<unsigned char> src(stride * h, 255);
+	unsigned int state = 7;
+	for(int y=0; y<h; y++) {
+		for(int x=0; x<w; x++) {
+			state = state * 1664525 + 1013904223;
+			src[y * stride + x] = state >> 24;
+		}
+	}
+	vector<uint32_t> integral((w + 1) * (h + 1));
+	ofxARToolkitPlusIntegralImage(&src[0], stride, w, h, &integral[0]);
+	bool same = true;
+	for(int y=0; y<=h && same; y++) {
+		for(int x=0; x<=w; x++) {
+			uint32_t sum = 0;
+			for(int yy=0; yy<y; yy++) {
+				for(int xx=0; xx<x; xx++) {
+					sum += src[yy * stride + xx];
+				}
+			}
+			if(integral[y * (w + 1) + x] != sum) {
+				ofLog(OF_LOG_ERROR, "testIntegralImage: sum at " + ofToString(x) + ", " + ofToString(y) + " is wrong");
+				same = false;
+				break;
+			}
+		}
+	}
+	TEST_CHECK(same);
+}
+
+//--------------------------------------------------
+// Brute force: the mean of the box cut off at the ends of the row, rounded the way the mask documents it
+static bool isLocallyDark(const vector<unsigned char> &image, int w, int y0, int y1, int x, int halfWindow, int offset) {
+	int x0 = std::max(x - halfWindow, 0);
+	int x1 = std::min(x + halfWindow + 1, w);
+	uint32_t sum = 0;
+	for(int y=y0; y<y1; y++) {
+		for(int xx=x0; xx<x1; xx++) {
+			sum += image[y * w + xx];
+		}
+	}
+	int limit = (int)(sum * (1.0f / ((x1 - x0) * (y1 - y0))) + 0.5f) - offset;
+	limit = std::min(std::max(limit, 0), 255);
+	return image[((y0 + y1) / 2) * w + x] < limit;
+}
+
+static void testLocalThresholdMask() {
+	const int widths[] = { 17, 40, 131 };
+	const int halfWindows[] = { 1, 4, 16, 70 };
+	const int offsets[] = { -300, 0, 7, 300 };
+	bool same = true;
+	for(size_t k=0; k<sizeof(widths) / sizeof(widths[0]) && same; k++) {
+		int w = widths[k];
+		int h = 24;
+		vector<unsigned char> image(w * h);
+		unsigned int state = w;
+		for(int i=0; i<w*h; i++) {
+			state = state * 1664525 + 1013904223;
+			// A gradient with noise, and some saturated pixels
+			int value = (i % w) * 255 / w + (int)(state >> 27) - 16;
+			image[i] = (i % 11 == 0) ? 0 : (i % 13 == 0 ? 255 : std::min(std::max(value, 0), 255));
+		}
+		vector<uint32_t> integral((w + 1) * (h + 1));
+		ofxARToolkitPlusIntegralImage(&image[0], w, w, h, &integral[0]);
+
+		for(size_t hw=0; hw<sizeof(halfWindows) / sizeof(halfWindows[0]); hw++) {
+			for(size_t o=0; o<sizeof(offsets) / sizeof(offsets[0]); o++) {
+				int halfWindow = halfWindows[hw];
+				int offset = offsets[o];
+				// Boxes cut off at the top of the image, and whole ones
+				int boxes[][2] = { { 0, 3 }, { 2, 11 }, { 5, 24 } };
+				for(int b=0; b<3; b++) {
+					int y0 = boxes[b][0];
+					int y1 = boxes[b][1];
+					int y = (y0 + y1) / 2;
+					// Runs starting at the left end, near it, in the middle, and ending at or before the right end
+					int runs[][2] = { { 0, w }, { 1, w - 1 }, { halfWindow - 1, w - halfWindow + 1 }, { w / 2, w - w / 2 }, { w - 3, 3 }, { 0, 1 } };
+					for(int r=0; r<6; r++) {
+						int first = runs[r][0];
+						int numPixels = std::min(runs[r][1], w - first);
+						if(first < 0 || first >= w || numPixels <= 0) {
+							continue;
+						}
+						vector<uint64_t> mask((numPixels + 63) / 64 + 1, 0);
+						ofxARToolkitPlusLocalThresholdMask(&image[y * w + first], &integral[y0 * (w + 1)], &integral[y1 * (w + 1)], w, y1 - y0,
+							first, numPixels, halfWindow, offset, &mask[0]);
+						for(int i=0; i<numPixels; i++) {
+							bool bit = (mask[i / 64] >> (i % 64)) & 1;
+							if(bit != isLocallyDark(image, w, y0, y1, first + i, halfWindow, offset)) {
+								ofLog(OF_LOG_ERROR, "testLocalThresholdMask: width " + ofToString(w) + " half window " + ofToString(halfWindow) +
+									" offset " + ofToString(offset) + " differs at " + ofToString(first + i));
+								same = false;
+								break;
+							}
+						}
+						// The bits past the run stay 0
+						for(int i=numPixels; i<(int)mask.size() * 64 && same; i++) {
+							same = ((mask[i / 64] >> (i % 64)) & 1) == 0;
+						}
+					}
+				}
+			}
+		}
+	}
+	TEST_CHECK(same);
+}
+
+//--------------------------------------------------
+// Tells how many pixels went into the integral images of the last frame
+class IntegralAreaTracker : public ofxARToolkitPlusTracker {
+public:
+	IntegralAreaTracker(int w, int h) : ofxARToolkitPlusTracker(w, h, 8, 6, 6, 6, 0) {}
+	int getIntegralArea() const {
+		int area = 0;
+		for(size_t i=0; i<integralBounds.size(); i++) {
+			area += (integralBounds[i].x1 - integralBounds[i].x0) * (integralBounds[i].y1 - integralBounds[i].y0);
+		}
+		return area;
+	}
+};
+
+//--------------------------------------------------
+void testAdaptiveThreshold() {
+	ofLog(OF_LOG_NOTICE, "testAdaptiveThreshold");
+	testIntegralImage();
+	testLocalThresholdMask();
+
+	const int w = 640;
+	const int h = 480;
+	ARToolKitPlus::TrackerMultiMarker library(w, h, 8, 6, 6, 6, 0);
+	ofxARToolkitPlusTracker tracker(w, h, 8, 6, 6, 6, 0);
+	if(!TEST_CHECK(setupTestTracker(library) && setupTestTracker(tracker))) {
+		return;
+	}
+	tracker.activateAdaptiveThreshold(true, 24, 7);
+	TEST_CHECK(tracker.isAdaptiveThresholdActivated());
+
+	// Light falling off from left to right: no single threshold fits the markers at both ends
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 90, 150, 70, 0.2f, 0 });
+	markers.push_back({ 481, 320, 300, 70, -0.3f, 0 });
+	markers.push_back({ 482, 560, 150, 70, 0.5f, 0 });
+	vector<unsigned char> pixels;
+	renderTestFrame(pixels, w, h, markers);
+	for(int y=0; y<h; y++) {
+		for(int x=0; x<w; x++) {
+			float light = 1.0f - 0.8f * x / w;
+			pixels[y * w + x] = (unsigned char)(pixels[y * w + x] * light);
+		}
+	}
+	library.calc(&pixels[0]);
+	tracker.calc(&pixels[0]);
+	TEST_CHECK(countIdentifiedMarkers(library) < 3);
+	TEST_CHECK(countIdentifiedMarkers(tracker) == 3);
+	for(size_t i=0; i<markers.size(); i++) {
+		TEST_CHECK(findMarker(tracker, markers[i].id) != NULL);
+	}
+
+	// Detection ROIs in opposite corners find the same markers, each with an integral image of its own
+	// instead of one over the frame between them
+	IntegralAreaTracker fullTracker(w, h);
+	IntegralAreaTracker roiTracker(w, h);
+	if(!TEST_CHECK(setupTestTracker(fullTracker) && setupTestTracker(roiTracker))) {
+		return;
+	}
+	fullTracker.activateAdaptiveThreshold(true, 24, 7);
+	roiTracker.activateAdaptiveThreshold(true, 24, 7);
+	vector<TestMarker> corners;
+	corners.push_back({ 480, 70, 70, 70, 0.2f, 0 });
+	corners.push_back({ 482, 570, 410, 70, 0.5f, 0 });
+	renderTestFrame(pixels, w, h, corners);
+	ofRectangle rois[2] = { ofRectangle(0, 0, 160, 160), ofRectangle(w - 160, h - 160, 160, 160) };
+	roiTracker.setDetectionROIs(rois, 2);
+	fullTracker.calc(&pixels[0]);
+	roiTracker.calc(&pixels[0]);
+	TEST_CHECK(countIdentifiedMarkers(roiTracker) == 2);
+	TEST_CHECK(sameMarkers(fullTracker, roiTracker));
+	// Each ROI with the 24 pixel window margin towards the middle of the frame
+	TEST_CHECK(fullTracker.getIntegralArea() == w * h);
+	TEST_CHECK(roiTracker.getIntegralArea() == 2 * (160 + 24) * (160 + 24));
+}
@@ -0,0 +1,101 @@
+#include "tests.h"
+#include "testUtils.h"
+#include "ofxARToolkitPlusAsync.h"
+
+//--------------------------------------------------
+// Wait for the tracking thread to publish the given frame - returns false after 10 seconds
+static bool waitForFrame(ofxARToolkitPlusAsync &async, unsigned long long frame) {
+	for(int i=0; i<10000; i++) {
+		if(async.getResult().frame >= frame) {
+			return true;
+		}
+		ofSleepMillis(1);
+	}
+	return false;
+}
+
+//--------------------------------------------------
+void testAsync() {
+	ofLog(OF_LOG_NOTICE, "testAsync");
+	const int w = 640;
+	const int h = 480;
+	vector<TestMarker> markers;
+	addTestBoard(markers, w / 2, h / 2, 1.1f);
+	vector<unsigned char> board;
+	vector<unsigned char> blank;
+	renderTestFrame(board, w, h, markers);
+	renderTestFrame(blank, w, h, vector<TestMarker>());
+
+	ofxARToolkitPlusAsync async;
+	async.setQueueSize(2);
+	async.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg", 24);
+	TEST_CHECK(async.getResult().frame == 0);
+	TEST_CHECK(!async.isFrameNew());
+
+	// Hold the tracking thread in a configure() call while 5 frames come in: the queue of 2
+	// keeps the newest two and drops the three oldest
+	std::atomic<bool> holding(false);
+	std::atomic<bool> release(false);
+	async.configure([&holding, &release](ofxARToolkitPlus &tracker) {
+		holding = true;
+		while(!release) {
+			ofSleepMillis(1);
+		}
+	});
+	while(!holding) {
+		ofSleepMillis(1);
+	}
+	for(int i=0; i<5; i++) {
+		async.update(&board[0]);
+	}
+	TEST_CHECK(async.getNumSubmittedFrames() == 5);
+	TEST_CHECK(async.getNumDroppedFrames() == 3);
+	TEST_CHECK(async.getNumTrackedFrames() == 0);
+	ofSleepMillis(20);
+	release = true;
+
+	TEST_CHECK(waitForFrame(async, 5));
+	TEST_CHECK(async.getNumTrackedFrames() == 2);
+	TEST_CHECK(async.getNumDroppedFrames() == 3);
+	// Picked up by getResult() above, so nothing new until the next frame
+	TEST_CHECK(!async.isFrameNew());
+	const ofxARToolkitPlusAsync::Result &result = async.getResult();
+	TEST_CHECK(result.frame == 5);
+	// The frames waited for the held thread
+	TEST_CHECK(result.queueMicros >= 20000 && result.latencyMicros >= result.queueMicros);
+	TEST_CHECK(result.markers.size() == 20 && result.poses.size() == 20);
+	bool sameOrder = true;
+	for(size_t i=0; i<result.markers.size() && i<result.poses.size(); i++) {
+		sameOrder = sameOrder && result.markers[i].id == result.poses[i].id;
+	}
+	TEST_CHECK(sameOrder);
+	TEST_CHECK(result.multiMarkerNumVisible == 20 && result.multiMarkerTranslation.z > 0);
+
+	// A frame without the board does not keep the board pose of an older frame in the same buffer
+	bool coherent = true;
+	unsigned long long frame = 5;
+	int numVisible = result.multiMarkerNumVisible;
+	for(int i=0; i<10 && numVisible > 0; i++) {
+		async.update(&blank[0]);
+		frame++;
+		coherent = coherent && waitForFrame(async, frame);
+		const ofxARToolkitPlusAsync::Result &blankResult = async.getResult();
+		numVisible = blankResult.multiMarkerNumVisible;
+		coherent = coherent && blankResult.markers.size() == blankResult.poses.size();
+	}
+	const ofxARToolkitPlusAsync::Result &blankResult = async.getResult();
+	TEST_CHECK(coherent);
+	TEST_CHECK(blankResult.multiMarkerNumVisible == 0);
+	const float *orientation = blankResult.multiMarkerOrientation.getPtr();
+	bool identity = true;
+	for(int i=0; i<16; i++) {
+		identity = identity && orientation[i] == (i % 5 == 0 ? 1 : 0);
+	}
+	TEST_CHECK(identity && blankResult.multiMarkerTranslation.x == 0 && blankResult.multiMarkerTranslation.y == 0 && blankResult.multiMarkerTranslation.z == 0);
+
+	async.resetFrameCounters();
+	TEST_CHECK(async.getNumSubmittedFrames() == 0 && async.getNumTrackedFrames() == 0 && async.getNumDroppedFrames() == 0);
+	async.stop();
+	// The queue size is fixed while the thread runs
+	async.setQueueSize(3);
+}
@@ -0,0 +1,89 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+static void testHistogramThresholds() {
+	unsigned int histogram[256];
+
+	// Nothing to split: no pixels, or all of them the same gray
+	memset(histogram, 0, sizeof(histogram));
+	TEST_CHECK(ofxARToolkitPlusOtsuThreshold(histogram) == -1);
+	TEST_CHECK(ofxARToolkitPlusBimodalThreshold(histogram) == -1);
+	int flatValues[] = { 0, 128, 255 };
+	for(int i=0; i<3; i++) {
+		memset(histogram, 0, sizeof(histogram));
+		histogram[flatValues[i]] = 1000;
+		TEST_CHECK(ofxARToolkitPlusOtsuThreshold(histogram) == -1);
+		TEST_CHECK(ofxARToolkitPlusBimodalThreshold(histogram) == -1);
+	}
+
+	// -1 passed on as a threshold marks no pixel dark
+	vector<unsigned char> pixels(100, 0);
+	vector<uint64_t> mask(2, ~0ULL);
+	ofxARToolkitPlusThresholdMask(&pixels[0], pixels.size(), ofxARToolkitPlusOtsuThreshold(histogram), &mask[0]);
+	TEST_CHECK(mask[0] == 0 && mask[1] == 0);
+
+	// Two gray values: Otsu takes the middle of the gap between them
+	memset(histogram, 0, sizeof(histogram));
+	histogram[40] = 300;
+	histogram[200] = 700;
+	TEST_CHECK(ofxARToolkitPlusOtsuThreshold(histogram) == (40 + 199) / 2);
+
+	// Two noisy peaks: both land between them, the valley near its bottom
+	memset(histogram, 0, sizeof(histogram));
+	unsigned int state = 1;
+	for(int i=0; i<20000; i++) {
+		state = state * 1664525 + 1013904223;
+		int noise = (int)(state >> 28) + (int)((state >> 20) & 15) - 15;
+		histogram[i % 3 == 0 ? 50 + noise : 180 + noise]++;
+	}
+	int otsu = ofxARToolkitPlusOtsuThreshold(histogram);
+	int bimodal = ofxARToolkitPlusBimodalThreshold(histogram);
+	TEST_CHECK(otsu > 65 && otsu < 165);
+	TEST_CHECK(bimodal > 65 && bimodal < 165);
+}
+
+//--------------------------------------------------
+static void testTrackerThreshold(ofxARToolkitPlusTracker::AutoThresholdMethod method) {
+	const int w = 640;
+	const int h = 480;
+	ofxARToolkitPlusTracker tracker(w, h, 8, 6, 6, 6, 0);
+	if(!TEST_CHECK(setupTestTracker(tracker))) {
+		return;
+	}
+	tracker.activateAutoThreshold(true);
+	tracker.setAutoThresholdMethod(method, false);
+	TEST_CHECK(tracker.getAutoThresholdMethod() == method);
+
+	// Blank frames give flat histograms: nothing is found and the threshold stays
+	int values[] = { 0, 200, 255 };
+	for(int i=0; i<3; i++) {
+		vector<unsigned char> blank(w * h, values[i]);
+		tracker.calc(&blank[0]);
+		TEST_CHECK(tracker.getNumDetectedMarkers() == 0);
+		TEST_CHECK(tracker.getThreshold() == 85);
+	}
+
+	// A dark frame with the markers barely lighter than their border: the threshold moves between them
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 200, 200, 80, 0.2f, 0 });
+	markers.push_back({ 481, 450, 280, 90, -0.3f, 0 });
+	vector<unsigned char> pixels;
+	renderTestFrame(pixels, w, h, markers);
+	for(size_t i=0; i<pixels.size(); i++) {
+		pixels[i] = pixels[i] / 4;
+	}
+	for(int frame=0; frame<3; frame++) {
+		tracker.calc(&pixels[0]);
+	}
+	TEST_CHECK(countIdentifiedMarkers(tracker) == 2);
+	TEST_CHECK(tracker.getThreshold() > 30 / 4 && tracker.getThreshold() < 240 / 4);
+}
+
+//--------------------------------------------------
+void testAutoThreshold() {
+	ofLog(OF_LOG_NOTICE, "testAutoThreshold");
+	testHistogramThresholds();
+	testTrackerThreshold(ofxARToolkitPlusTracker::AUTO_THRESHOLD_OTSU);
+	testTrackerThreshold(ofxARToolkitPlusTracker::AUTO_THRESHOLD_BIMODAL);
+}
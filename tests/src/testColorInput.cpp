@@ -0,0 +1,174 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+// BT.601 in 1/256, one pixel at a time
+static unsigned char referenceGray(const unsigned char *pixel, ARToolKitPlus::PIXEL_FORMAT format) {
+	int r = 0, g = 0, b = 0;
+	switch(format) {
+		case ARToolKitPlus::PIXEL_FORMAT_RGB:
+		case ARToolKitPlus::PIXEL_FORMAT_RGBA:
+			r = pixel[0]; g = pixel[1]; b = pixel[2];
+			break;
+		case ARToolKitPlus::PIXEL_FORMAT_BGR:
+		case ARToolKitPlus::PIXEL_FORMAT_BGRA:
+			b = pixel[0]; g = pixel[1]; r = pixel[2];
+			break;
+		case ARToolKitPlus::PIXEL_FORMAT_ABGR:
+			b = pixel[1]; g = pixel[2]; r = pixel[3];
+			break;
+		case ARToolKitPlus::PIXEL_FORMAT_RGB565: {
+			int value = pixel[0] | (pixel[1] << 8);
+			// 5 and 6 bits widened to 8 by repeating their top bits
+			int rBits = (value >> 11) & 0x1f, gBits = (value >> 5) & 0x3f, bBits = value & 0x1f;
+			r = (rBits << 3) | (rBits >> 2);
+			g = (gBits << 2) | (gBits >> 4);
+			b = (bBits << 3) | (bBits >> 2);
+			break;
+		}
+		default:
+			return pixel[0];
+	}
+	return (77 * r + 150 * g + 29 * b + 128) >> 8;
+}
+
+//--------------------------------------------------
+static const ARToolKitPlus::PIXEL_FORMAT colorFormats[] = {
+	ARToolKitPlus::PIXEL_FORMAT_RGB, ARToolKitPlus::PIXEL_FORMAT_BGR, ARToolKitPlus::PIXEL_FORMAT_RGBA,
+	ARToolKitPlus::PIXEL_FORMAT_BGRA, ARToolKitPlus::PIXEL_FORMAT_ABGR, ARToolKitPlus::PIXEL_FORMAT_RGB565
+};
+static const int numColorFormats = sizeof(colorFormats) / sizeof(colorFormats[0]);
+
+//--------------------------------------------------
+static void testConvertToGray() {
+	const int bytesPerPixel[] = { 3, 3, 4, 4, 4, 2 };
+	bool sizes = ofxARToolkitPlusGetBytesPerPixel(ARToolKitPlus::PIXEL_FORMAT_LUM) == 1;
+	for(int f=0; f<numColorFormats; f++) {
+		sizes = sizes && ofxARToolkitPlusGetBytesPerPixel(colorFormats[f]) == bytesPerPixel[f];
+	}
+	TEST_CHECK(sizes);
+
+	// Every length up to a few vectors of the widest kernel, so each ends at every possible offset.
+	// The byte past the last gray pixel must be left alone
+	bool same = true;
+	for(int f=0; f<numColorFormats && same; f++) {
+		ARToolKitPlus::PIXEL_FORMAT format = colorFormats[f];
+		int size = bytesPerPixel[f];
+		for(int numPixels=0; numPixels<=100 && same; numPixels++) {
+			vector<unsigned char> src(numPixels * size + 1);
+			unsigned int state = numPixels * 7 + f;
+			for(size_t i=0; i<src.size(); i++) {
+				state = state * 1664525 + 1013904223;
+				src[i] = state >> 24;
+			}
+			if(numPixels > 1) {
+				memset(&src[0], 0, size);
+				memset(&src[size], 255, size);
+			}
+			vector<unsigned char> dst(numPixels + 1, 17);
+			ofxARToolkitPlusConvertToGray(&src[0], &dst[0], numPixels, format);
+			for(int i=0; i<numPixels; i++) {
+				if(dst[i] != referenceGray(&src[i * size], format)) {
+					ofLog(OF_LOG_ERROR, "testConvertToGray: pixel " + ofToString(i) + " of " + ofToString(numPixels) + " in format " + ofToString(format) +
+						" is " + ofToString((int)dst[i]) + " instead of " + ofToString((int)referenceGray(&src[i * size], format)));
+					same = false;
+					break;
+				}
+			}
+			same = same && dst[numPixels] == 17;
+		}
+	}
+	TEST_CHECK(same);
+}
+
+//--------------------------------------------------
+// The gray source frame in the given format, with the channels a few levels apart so mixing
+// them up changes the result. gray gets the reference conversion of it
+static void makeColorFrame(const vector<unsigned char> &source, ARToolKitPlus::PIXEL_FORMAT format, vector<unsigned char> &color, vector<unsigned char> &gray) {
+	int size = ofxARToolkitPlusGetBytesPerPixel(format);
+	color.resize(source.size() * size);
+	gray.resize(source.size());
+	for(size_t i=0; i<source.size(); i++) {
+		unsigned char *pixel = &color[i * size];
+		int v = source[i];
+		int r = std::min(v + 12, 255), g = v, b = std::max(v - 20, 0);
+		switch(format) {
+			case ARToolKitPlus::PIXEL_FORMAT_RGB:
+			case ARToolKitPlus::PIXEL_FORMAT_RGBA:
+				pixel[0] = r; pixel[1] = g; pixel[2] = b;
+				break;
+			case ARToolKitPlus::PIXEL_FORMAT_BGR:
+			case ARToolKitPlus::PIXEL_FORMAT_BGRA:
+				pixel[0] = b; pixel[1] = g; pixel[2] = r;
+				break;
+			case ARToolKitPlus::PIXEL_FORMAT_ABGR:
+				pixel[0] = 255; pixel[1] = b; pixel[2] = g; pixel[3] = r;
+				break;
+			default: {
+				int value = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+				pixel[0] = value & 0xff;
+				pixel[1] = value >> 8;
+				break;
+			}
+		}
+		if(size == 4 && format != ARToolKitPlus::PIXEL_FORMAT_ABGR) {
+			pixel[3] = 255;
+		}
+		gray[i] = referenceGray(pixel, format);
+	}
+}
+
+//--------------------------------------------------
+void testColorInput() {
+	ofLog(OF_LOG_NOTICE, "testColorInput");
+	testConvertToGray();
+
+	const int w = 640;
+	const int h = 480;
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 160, 160, 90, 0.2f, 0 });
+	markers.push_back({ 481, 460, 180, 90, -0.3f, 0.1f });
+	markers.push_back({ 482, 320, 350, 90, 0.6f, 0 });
+	vector<unsigned char> source;
+	renderTestFrame(source, w, h, markers);
+
+	// Every way of passing a color frame finds the markers of its gray conversion
+	const ofPixelFormat pixelFormats[] = { OF_PIXELS_RGB, OF_PIXELS_BGR, OF_PIXELS_RGBA, OF_PIXELS_BGRA, OF_PIXELS_UNKNOWN, OF_PIXELS_RGB565 };
+	const ofxARToolkitPlus::InputFormat inputFormats[] = {
+		ofxARToolkitPlus::INPUT_RGB, ofxARToolkitPlus::INPUT_BGR, ofxARToolkitPlus::INPUT_RGBA,
+		ofxARToolkitPlus::INPUT_BGRA, ofxARToolkitPlus::INPUT_ABGR, ofxARToolkitPlus::INPUT_RGB565
+	};
+	vector<unsigned char> color, gray;
+	for(int f=0; f<numColorFormats; f++) {
+		makeColorFrame(source, colorFormats[f], color, gray);
+		ofxARToolkitPlus expected, raw, input;
+		expected.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+		raw.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+		input.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+		expected.update(&gray[0]);
+		TEST_CHECK(expected.getNumDetectedMarkers() == 3);
+		raw.update(&color[0], colorFormats[f]);
+		TEST_CHECK(sameMarkers(expected, raw));
+		input.update(ofxARToolkitPlus::InputImage(&color[0], inputFormats[f]));
+		TEST_CHECK(sameMarkers(expected, input));
+		if(pixelFormats[f] != OF_PIXELS_UNKNOWN) {
+			ofxARToolkitPlus fromPixels;
+			fromPixels.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+			ofPixels pixels;
+			pixels.allocate(w, h, pixelFormats[f]);
+			memcpy(pixels.getData(), &color[0], color.size());
+			fromPixels.update(pixels);
+			TEST_CHECK(sameMarkers(expected, fromPixels));
+		}
+	}
+
+	// ofPixels of another size or a format without luminance are turned down
+	ofxARToolkitPlus artk;
+	artk.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+	ofPixels smaller;
+	smaller.allocate(w / 2, h / 2, OF_PIXELS_RGB);
+	TEST_CHECK(artk.update(smaller) == 0);
+	ofPixels grayAlpha;
+	grayAlpha.allocate(w, h, OF_PIXELS_GRAY_ALPHA);
+	TEST_CHECK(artk.update(grayAlpha) == 0);
+}
@@ -0,0 +1,75 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+// The entry computeAllPoses() wrote for marker i holds what the single marker getters return
+static bool sameAsGetters(ofxARToolkitPlus &artk, int i, const ofxARToolkitPlus::MarkerPose &pose) {
+	if(pose.id != artk.getMarkerID(i) || pose.error < 0 ||
+	   (pose.estimator != ARToolKitPlus::POSE_ESTIMATOR_RPP && pose.estimator != ARToolKitPlus::POSE_ESTIMATOR_ORIGINAL)) {
+		return false;
+	}
+	ofMatrix4x4 matrix = artk.getMatrix(i);
+	ofMatrix4x4 glMatrix = artk.getGLMatrix(i);
+	const float *m = matrix.getPtr();
+	for(int r=0; r<3; r++) {
+		for(int c=0; c<4; c++) {
+			if(pose.matrix[r][c] != m[r * 4 + c]) {
+				return false;
+			}
+		}
+	}
+	return memcmp(pose.glMatrix, glMatrix.getPtr(), sizeof(pose.glMatrix)) == 0;
+}
+
+//--------------------------------------------------
+void testComputeAllPoses() {
+	ofLog(OF_LOG_NOTICE, "testComputeAllPoses");
+	const int w = 640;
+	const int h = 480;
+	ofxARToolkitPlus artk;
+	artk.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg", 24);
+	vector<TestMarker> markers;
+	addTestBoard(markers, w / 2, h / 2, 1.1f, 0.1f);
+	vector<unsigned char> pixels;
+	renderTestFrame(pixels, w, h, markers);
+	artk.update(&pixels[0]);
+	int numDetected = artk.getNumDetectedMarkers();
+	if(!TEST_CHECK(numDetected == 20)) {
+		return;
+	}
+
+	// One solve per marker, the getters afterwards are all served from the cache
+	artk.resetPoseCacheStats();
+	vector<ofxARToolkitPlus::MarkerPose> poses(3);
+	TEST_CHECK(artk.computeAllPoses(poses) == numDetected);
+	TEST_CHECK((int)poses.size() == numDetected);
+	TEST_CHECK((int)artk.getPoseCacheMisses() == numDetected);
+	bool same = true;
+	for(int i=0; i<numDetected; i++) {
+		same = same && sameAsGetters(artk, i, poses[i]);
+	}
+	TEST_CHECK(same);
+	TEST_CHECK((int)artk.getPoseCacheMisses() == numDetected);
+
+	// A filled vector is reused without allocating, and one bigger than needed keeps its size
+	unsigned long long allocations = getNumHeapAllocations();
+	TEST_CHECK(artk.computeAllPoses(poses) == numDetected);
+	TEST_CHECK(getNumHeapAllocations() == allocations);
+	vector<ofxARToolkitPlus::MarkerPose> bigger(numDetected + 5);
+	TEST_CHECK(artk.computeAllPoses(bigger) == numDetected && (int)bigger.size() == numDetected + 5);
+	TEST_CHECK(memcmp(&bigger[0], &poses[0], numDetected * sizeof(poses[0])) == 0);
+
+	// Only as many as there is room for
+	ofxARToolkitPlus::MarkerPose some[5];
+	TEST_CHECK(artk.computeAllPoses(some, 5) == 5);
+	TEST_CHECK(memcmp(some, &poses[0], sizeof(some)) == 0);
+	TEST_CHECK(artk.computeAllPoses(some, 0) == 0);
+
+	// Nothing detected, nothing written
+	ofxARToolkitPlus empty;
+	empty.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg", 24);
+	renderTestFrame(pixels, w, h, vector<TestMarker>());
+	empty.update(&pixels[0]);
+	vector<ofxARToolkitPlus::MarkerPose> none;
+	TEST_CHECK(empty.computeAllPoses(none) == 0 && none.empty());
+}
@@ -0,0 +1,83 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+// A dark frame around an empty rectangle: a candidate with a long contour but little area
+static void drawOutline(vector<unsigned char> &pixels, int w, int x0, int y0, int x1, int y1, int thickness) {
+	for(int y=y0; y<y1; y++) {
+		for(int x=x0; x<x1; x++) {
+			if(x < x0 + thickness || x >= x1 - thickness || y < y0 + thickness || y >= y1 - thickness) {
+				pixels[y * w + x] = 30;
+			}
+		}
+	}
+}
+
+//--------------------------------------------------
+void testContours() {
+	ofLog(OF_LOG_NOTICE, "testContours");
+	const int w = 3840;
+	const int h = 2160;
+
+	ARToolKitPlus::TrackerMultiMarker library(w, h, 32, 6, 6, 6, 0);
+	ofxARToolkitPlusTracker tracker(w, h, 32, 6, 6, 6, 0);
+	if(!TEST_CHECK(setupTestTracker(library) && setupTestTracker(tracker))) {
+		return;
+	}
+
+	// Many candidates of all sizes, up to about the largest area a candidate may have,
+	// and an outline whose contour is about 8000 points long
+	vector<TestMarker> markers;
+	for(int i=0; i<20; i++) {
+		float size = 60 + (i % 5) * 55;
+		markers.push_back({ 480 + (i % 20), 450.0f + (i % 5) * 700, 500.0f + (i / 5) * 380, size, 0.15f * i, (i % 3) * 0.1f });
+	}
+	vector<unsigned char> pixels;
+	bool same = true;
+	for(int frame=0; frame<3; frame++) {
+		for(size_t i=0; i<markers.size(); i++) {
+			markers[i].x += 4;
+			markers[i].angle += 0.02f;
+		}
+		renderTestFrame(pixels, w, h, markers);
+		addTestBlobs(pixels, w, h, 3000, 8, frame);
+		drawOutline(pixels, w, 200, 200, 2200, 2100, 10);
+		library.calc(&pixels[0]);
+		tracker.calc(&pixels[0]);
+		same = sameMarkers(library, tracker) && same;
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(countIdentifiedMarkers(tracker) > 10);
+
+	// Past AR_CHAIN_MAX points the library gives up on a contour, the tracker does not. Only
+	// arDetectMarker() reports the candidates without an id. Fresh trackers, without the markers
+	// of the frames above in their history
+	ARToolKitPlus::TrackerMultiMarker longLibrary(w, h, 32, 6, 6, 6, 0);
+	ofxARToolkitPlusTracker longTracker(w, h, 32, 6, 6, 6, 0);
+	setupTestTracker(longLibrary);
+	setupTestTracker(longTracker);
+	vector<TestMarker> inside;
+	inside.push_back({ 480, 1000, 1000, 200, 0.3f, 0 });
+	inside.push_back({ 481, 2500, 1200, 250, -0.2f, 0 });
+	renderTestFrame(pixels, w, h, inside);
+	drawOutline(pixels, w, 100, 100, 3700, 2000, 6);
+	ARToolKitPlus::ARMarkerInfo *libraryInfo, *trackerInfo;
+	int numLibrary = 0, numTracker = 0;
+	TEST_CHECK(longLibrary.arDetectMarker(&pixels[0], 85, &libraryInfo, &numLibrary) == 0);
+	TEST_CHECK(longTracker.arDetectMarker(&pixels[0], 85, &trackerInfo, &numTracker) == 0);
+	TEST_CHECK(numTracker == numLibrary + 1);
+	// The markers inside are the same, the one more candidate is the outline
+	const int outlineArea = (3600 + 1900) * 2 * 6 - 4 * 6 * 6;
+	int numSame = 0;
+	bool foundOutline = false;
+	for(int i=0; i<numTracker; i++) {
+		for(int j=0; j<numLibrary; j++) {
+			if(trackerInfo[i].id == libraryInfo[j].id && trackerInfo[i].dir == libraryInfo[j].dir && cornerDistance(trackerInfo[i], libraryInfo[j]) < 1e-3f) {
+				numSame++;
+			}
+		}
+		foundOutline = foundOutline || (trackerInfo[i].id < 0 && trackerInfo[i].area == outlineArea);
+	}
+	TEST_CHECK(numLibrary >= 2 && numSame == numLibrary);
+	TEST_CHECK(foundOutline);
+}
@@ -0,0 +1,86 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+void testDetectionROI() {
+	ofLog(OF_LOG_NOTICE, "testDetectionROI");
+	const int w = 640;
+	const int h = 480;
+
+	ARToolKitPlus::TrackerMultiMarker library(w, h, 8, 6, 6, 6, 0);
+	ofxARToolkitPlusTracker tracker(w, h, 8, 6, 6, 6, 0);
+	if(!TEST_CHECK(setupTestTracker(library) && setupTestTracker(tracker))) {
+		return;
+	}
+
+	// A rectangle over the whole image labels the same pixels as none, in both detection modes
+	ofRectangle wholeImage(0, 0, w, h);
+	tracker.setDetectionROIs(&wholeImage, 1);
+	vector<unsigned char> pixels;
+	for(int lite=0; lite<2; lite++) {
+		library.setUseDetectLite(lite == 1);
+		tracker.setUseDetectLite(lite == 1);
+		for(int frame=0; frame<20; frame++) {
+			vector<TestMarker> markers;
+			markers.push_back({ 480, 100 + frame * 3.0f, 120, 60, 0.3f + frame * 0.02f, 0.1f });
+			markers.push_back({ 9, 400, 300 + frame * 1.0f, 80, 1.0f, 0 });
+			markers.push_back({ 481, 500, 100, 50, 0.1f * frame, 0.2f });
+			renderTestFrame(pixels, w, h, markers);
+			addTestBlobs(pixels, w, h, 200, 6, frame);
+			library.calc(&pixels[0]);
+			tracker.calc(&pixels[0]);
+			TEST_CHECK(sameMarkers(library, tracker));
+		}
+	}
+	library.setUseDetectLite(false);
+	tracker.setUseDetectLite(false);
+
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 120, 120, 60, 0.3f, 0.1f });
+	markers.push_back({ 9, 400, 300, 80, 1.0f, 0 });
+	markers.push_back({ 481, 540, 100, 50, 0.4f, 0.2f });
+	renderTestFrame(pixels, w, h, markers);
+	library.calc(&pixels[0]);
+	TEST_CHECK(countIdentifiedMarkers(library) == 3);
+
+	// The trackers remember markers for a few frames, so every case starts on a fresh one
+	{
+		// A rectangle around one marker finds only that one, with the same corners
+		ofxARToolkitPlusTracker roiTracker(w, h, 8, 6, 6, 6, 0);
+		setupTestTracker(roiTracker);
+		ofRectangle aroundOne(300, 200, 200, 200);
+		roiTracker.setDetectionROIs(&aroundOne, 1);
+		roiTracker.calc(&pixels[0]);
+		const ARToolKitPlus::ARMarkerInfo *expected = findMarker(library, 9);
+		const ARToolKitPlus::ARMarkerInfo *found = findMarker(roiTracker, 9);
+		TEST_CHECK(countIdentifiedMarkers(roiTracker) == 1);
+		TEST_CHECK(found != NULL && expected != NULL && cornerDistance(*expected, *found) < 1e-3f);
+	}
+	{
+		// A marker touching the edge of the rectangle is dropped like one touching the edge of the image
+		ofxARToolkitPlusTracker roiTracker(w, h, 8, 6, 6, 6, 0);
+		setupTestTracker(roiTracker);
+		ofRectangle cuttingOne(380, 200, 200, 200);
+		roiTracker.setDetectionROIs(&cuttingOne, 1);
+		roiTracker.calc(&pixels[0]);
+		TEST_CHECK(countIdentifiedMarkers(roiTracker) == 0);
+	}
+	{
+		// Rectangles reaching out of the image are cut off, overlapping ones are merged
+		// and the marker in the overlap is found once
+		ofxARToolkitPlusTracker roiTracker(w, h, 8, 6, 6, 6, 0);
+		setupTestTracker(roiTracker);
+		ofRectangle rois[3] = { ofRectangle(-50, -50, 260, 260), ofRectangle(470, 30, 150, 150), ofRectangle(500, -20, 300, 150) };
+		roiTracker.setDetectionROIs(rois, 3);
+		roiTracker.calc(&pixels[0]);
+		TEST_CHECK(countIdentifiedMarkers(roiTracker) == 2);
+		TEST_CHECK(findMarker(roiTracker, 480) != NULL && findMarker(roiTracker, 481) != NULL);
+		TEST_CHECK(findMarker(roiTracker, 9) == NULL);
+
+		// No rectangles searches the whole image again
+		roiTracker.setDetectionROIs(NULL, 0);
+		TEST_CHECK(roiTracker.getNumDetectionROIs() == 0);
+		roiTracker.calc(&pixels[0]);
+		TEST_CHECK(sameMarkerCorners(library, roiTracker, 1e-3f));
+	}
+}
@@ -0,0 +1,86 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+static void testArena() {
+	ofxARToolkitPlusFrameArena arena;
+
+	// A frame that outgrows the first block gets more, the next reset makes them one
+	for(int i=0; i<100; i++) {
+		double *values = arena.alloc<double>(1000);
+		values[999] = i;
+	}
+	TEST_CHECK(arena.getNumBytesUsed() >= 100 * 1000 * sizeof(double));
+	unsigned int grown = arena.getNumBlockAllocations();
+	TEST_CHECK(grown > 1);
+	arena.reset();
+	TEST_CHECK(arena.getNumBytesUsed() == 0);
+	TEST_CHECK(arena.getNumBlockAllocations() == grown + 1);
+
+	// The same frames again fit, without touching the heap
+	unsigned long long heap = getNumHeapAllocations();
+	bool aligned = true;
+	for(int frame=0; frame<10; frame++) {
+		for(int i=0; i<100; i++) {
+			char *bytes = arena.alloc<char>(1 + i % 7);
+			double *values = arena.alloc<double>(999);
+			aligned = aligned && bytes != NULL && (uintptr_t)values % alignof(double) == 0;
+		}
+		arena.reset();
+	}
+	TEST_CHECK(aligned);
+	TEST_CHECK(arena.getNumBlockAllocations() == grown + 1);
+	TEST_CHECK(getNumHeapAllocations() == heap);
+}
+
+//--------------------------------------------------
+void testFrameArena() {
+	ofLog(OF_LOG_NOTICE, "testFrameArena");
+	testArena();
+
+	const int w = 640;
+	const int h = 480;
+	ARToolKitPlus::TrackerMultiMarker library(w, h, 8, 6, 6, 6, 0);
+	ofxARToolkitPlusTracker tracker(w, h, 8, 6, 6, 6, 0);
+	if(!TEST_CHECK(setupTestTracker(library) && setupTestTracker(tracker))) {
+		return;
+	}
+
+	// The same kind of scene over and over: once the buffers have grown for it, the arena takes
+	// no more blocks. Only arGetCode still allocates, a few times for every candidate.
+	// Detection only, the multi-marker pose of calc() is the library's and allocates on its own
+	vector<unsigned char> pixels;
+	unsigned int warmBlocks = 0;
+	unsigned long long trackerHeap = 0, libraryHeap = 0;
+	int numCandidates = 0;
+	bool bounded = true;
+	for(int frame=0; frame<40; frame++) {
+		vector<TestMarker> markers;
+		markers.push_back({ 480, 150 + (frame % 10) * 3.0f, 150, 80, 0.2f + (frame % 10) * 0.02f, 0.1f });
+		markers.push_back({ 481, 450, 300 - (frame % 10) * 2.0f, 90, -0.3f, 0 });
+		renderTestFrame(pixels, w, h, markers);
+		addTestBlobs(pixels, w, h, 300, 8, frame % 10);
+		ARToolKitPlus::ARMarkerInfo *info;
+		int num = 0, numLibrary = 0;
+		unsigned long long start = getNumHeapAllocations();
+		tracker.arDetectMarker(&pixels[0], 85, &info, &num);
+		unsigned long long detected = getNumHeapAllocations();
+		library.arDetectMarker(&pixels[0], 85, &info, &numLibrary);
+		if(frame == 9) {
+			warmBlocks = tracker.getFrameArena().getNumBlockAllocations();
+		}
+		else if(frame > 9) {
+			bounded = bounded && detected - start <= 10 * (unsigned long long)num;
+			trackerHeap += detected - start;
+			libraryHeap += getNumHeapAllocations() - detected;
+			numCandidates += num;
+		}
+	}
+	TEST_CHECK(warmBlocks > 0);
+	TEST_CHECK(tracker.getFrameArena().getNumBlockAllocations() == warmBlocks);
+	TEST_CHECK(numCandidates >= 2 * 30);
+	TEST_CHECK(bounded);
+	TEST_CHECK(trackerHeap < libraryHeap);
+	ofLog(OF_LOG_NOTICE, "testFrameArena: " + ofToString(trackerHeap) + " heap allocations detecting " + ofToString(numCandidates) +
+		" candidates in 30 frames after warm up, " + ofToString(libraryHeap) + " in the library");
+}
@@ -0,0 +1,141 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+// The 8x9 gaussian elimination getHomography() solved before the closed form, as the reference
+static void referenceHomography(const ofPoint src[4], const ofPoint dst[4], float homography[16]) {
+	float P[8][9];
+	for(int i=0; i<4; i++) {
+		float row0[9] = { -src[i].x, -src[i].y, -1, 0, 0, 0, src[i].x*dst[i].x, src[i].y*dst[i].x, -dst[i].x };
+		float row1[9] = { 0, 0, 0, -src[i].x, -src[i].y, -1, src[i].x*dst[i].y, src[i].y*dst[i].y, -dst[i].y };
+		memcpy(P[i*2], row0, sizeof(row0));
+		memcpy(P[i*2+1], row1, sizeof(row1));
+	}
+	float *A = &P[0][0];
+	const int n = 9;
+	const int m = n - 1;
+	int i = 0;
+	int j = 0;
+	while(i < m && j < n) {
+		int maxi = i;
+		for(int k=i+1; k<m; k++) {
+			if(fabs(A[k*n+j]) > fabs(A[maxi*n+j])) {
+				maxi = k;
+			}
+		}
+		if(A[maxi*n+j] != 0) {
+			for(int k=0; k<n && i!=maxi; k++) {
+				std::swap(A[i*n+k], A[maxi*n+k]);
+			}
+			float A_ij = A[i*n+j];
+			for(int k=0; k<n; k++) {
+				A[i*n+k] /= A_ij;
+			}
+			for(int u=i+1; u<m; u++) {
+				float A_uj = A[u*n+j];
+				for(int k=0; k<n; k++) {
+					A[u*n+k] -= A_uj*A[i*n+k];
+				}
+			}
+			i++;
+		}
+		j++;
+	}
+	for(int i=m-2; i>=0; i--) {
+		for(int j=i+1; j<n-1; j++) {
+			A[i*n+m] -= A[i*n+j]*A[j*n+m];
+		}
+	}
+	float H[16] = { P[0][8], P[3][8], 0, P[6][8],
+					P[1][8], P[4][8], 0, P[7][8],
+					0, 0, 0, 0,
+					P[2][8], P[5][8], 0, 1 };
+	memcpy(homography, H, sizeof(H));
+}
+
+//--------------------------------------------------
+// Where a homography in OpenGL order takes a point
+static ofPoint mapPoint(const float *H, float x, float y) {
+	float w = H[3]*x + H[7]*y + H[15];
+	return ofPoint((H[0]*x + H[4]*y + H[12]) / w, (H[1]*x + H[5]*y + H[13]) / w);
+}
+
+//--------------------------------------------------
+// Same layout as the reference, and the same mapping over the src quad to a hundredth of a pixel
+static bool sameHomography(const float *expected, const float *actual, const ofPoint src[4]) {
+	const int zeros[] = { 2, 6, 8, 9, 10, 11, 14 };
+	for(int i=0; i<7; i++) {
+		if(actual[zeros[i]] != 0) {
+			return false;
+		}
+	}
+	if(actual[15] != 1) {
+		return false;
+	}
+	for(int v=0; v<=4; v++) {
+		for(int u=0; u<=4; u++) {
+			// Bilinear over the quad, corners included
+			ofPoint top = src[0] + (src[1] - src[0]) * (u / 4.0f);
+			ofPoint bottom = src[3] + (src[2] - src[3]) * (u / 4.0f);
+			ofPoint p = top + (bottom - top) * (v / 4.0f);
+			if(ofDist(mapPoint(expected, p.x, p.y).x, mapPoint(expected, p.x, p.y).y, mapPoint(actual, p.x, p.y).x, mapPoint(actual, p.x, p.y).y) > 0.01f) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------
+void testHomography() {
+	ofLog(OF_LOG_NOTICE, "testHomography");
+	const int w = 640;
+	const int h = 480;
+	ofxARToolkitPlus artk;
+	artk.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+
+	// Tilted markers turned to every direction
+	vector<TestMarker> markers;
+	for(int i=0; i<6; i++) {
+		markers.push_back({ 480 + i, 110.0f + (i % 3) * 200, 130.0f + (i / 3) * 220, 90, 0.3f + i * 1.1f, (i % 3 - 1) * 0.25f });
+	}
+	vector<unsigned char> pixels;
+	renderTestFrame(pixels, w, h, markers);
+	artk.update(&pixels[0]);
+	int numDetected = artk.getNumDetectedMarkers();
+	TEST_CHECK(numDetected == 6);
+	bool allDirections[4] = { false, false, false, false };
+	for(int i=0; i<numDetected; i++) {
+		allDirections[artk.getDetectedMarkerDirection(i)] = true;
+	}
+	TEST_CHECK(allDirections[0] && allDirections[1] && allDirections[2] && allDirections[3]);
+
+	// The marker sized square getHomography() uses, the frame as a texture, and a quad that is no rectangle at all
+	vector<ofPoint> sources[3];
+	const float half = 20;
+	sources[0] = { ofPoint(-half, -half), ofPoint(half, -half), ofPoint(half, half), ofPoint(-half, half) };
+	sources[1] = { ofPoint(0, 0), ofPoint(w, 0), ofPoint(w, h), ofPoint(0, h) };
+	sources[2] = { ofPoint(10, 20), ofPoint(300, -5), ofPoint(280, 260), ofPoint(-15, 240) };
+	vector<float> all(numDetected * 16);
+	for(int s=0; s<3; s++) {
+		const vector<ofPoint> &src = sources[s];
+		bool same = true;
+		bool batched = true;
+		TEST_CHECK(artk.getAllHomographies(src, &all[0], numDetected) == numDetected);
+		for(int i=0; i<numDetected; i++) {
+			array<ofPoint, 4> dst;
+			artk.getDetectedMarkerOrderedBorderCorners(i, dst);
+			float expected[16];
+			referenceHomography(&src[0], &dst[0], expected);
+			ofMatrix4x4 single = s == 0 ? artk.getHomography(i) : artk.getHomography(i, src);
+			same = same && sameHomography(expected, single.getPtr(), &src[0]);
+			batched = batched && memcmp(single.getPtr(), &all[i * 16], 16 * sizeof(float)) == 0;
+		}
+		TEST_CHECK(same);
+		TEST_CHECK(batched);
+	}
+
+	// Only as many as there is room for, and nothing for a src that is not 4 points
+	TEST_CHECK(artk.getAllHomographies(&all[0], 2) == 2);
+	TEST_CHECK(artk.getAllHomographies(vector<ofPoint>(3), &all[0], numDetected) == 0);
+}
@@ -0,0 +1,118 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+static void testExtractLuma() {
+	// Every length up to a few vectors, each Y sample between random chroma
+	bool same = true;
+	for(int numPixels=0; numPixels<=70 && same; numPixels++) {
+		vector<unsigned char> src(numPixels * 2 + 1);
+		unsigned int state = numPixels;
+		for(size_t i=0; i<src.size(); i++) {
+			state = state * 1664525 + 1013904223;
+			src[i] = state >> 24;
+		}
+		for(int offset=0; offset<2 && same; offset++) {
+			vector<unsigned char> dst(numPixels + 1, 17);
+			ofxARToolkitPlusExtractLuma(&src[offset], &dst[0], std::max(numPixels - offset, 0));
+			for(int i=0; i<numPixels - offset; i++) {
+				same = same && dst[i] == src[offset + i * 2];
+			}
+			same = same && dst[std::max(numPixels - offset, 0)] == 17;
+		}
+	}
+	TEST_CHECK(same);
+}
+
+//--------------------------------------------------
+// The gray frame as format with stride bytes per row (of the Y plane), the bytes that are not luma
+// filled with noise. Chroma planes of NV12 and I420 follow the Y plane
+static void makeInputFrame(const vector<unsigned char> &gray, int w, int h, ofxARToolkitPlus::InputFormat format, int stride, vector<unsigned char> &frame) {
+	bool packed = format == ofxARToolkitPlus::INPUT_YUYV || format == ofxARToolkitPlus::INPUT_UYVY;
+	int planar = format == ofxARToolkitPlus::INPUT_NV12 || format == ofxARToolkitPlus::INPUT_I420 ? stride * h / 2 : 0;
+	frame.resize(stride * h + planar);
+	unsigned int state = stride + format;
+	for(size_t i=0; i<frame.size(); i++) {
+		state = state * 1664525 + 1013904223;
+		frame[i] = state >> 24;
+	}
+	int lumaOffset = format == ofxARToolkitPlus::INPUT_UYVY ? 1 : 0;
+	for(int y=0; y<h; y++) {
+		for(int x=0; x<w; x++) {
+			frame[y * stride + (packed ? x * 2 + lumaOffset : x)] = gray[y * w + x];
+		}
+	}
+}
+
+//--------------------------------------------------
+void testInputImage() {
+	ofLog(OF_LOG_NOTICE, "testInputImage");
+	testExtractLuma();
+
+	const int w = 640;
+	const int h = 480;
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 160, 160, 90, 0.2f, 0 });
+	markers.push_back({ 481, 460, 180, 90, -0.3f, 0.1f });
+	markers.push_back({ 482, 320, 350, 90, 0.6f, 0 });
+	vector<unsigned char> gray;
+	renderTestFrame(gray, w, h, markers);
+	ofxARToolkitPlus expected;
+	expected.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+	expected.update(&gray[0]);
+	TEST_CHECK(expected.getNumDetectedMarkers() == 3);
+
+	// Every luma layout, packed and with padded rows, finds the markers of the packed gray frame
+	struct Layout {
+		ofxARToolkitPlus::InputFormat format;
+		int bytesPerPixel;
+		ofPixelFormat pixelFormat;
+	};
+	const Layout layouts[] = {
+		{ ofxARToolkitPlus::INPUT_GRAY, 1, OF_PIXELS_GRAY },
+		{ ofxARToolkitPlus::INPUT_NV12, 1, OF_PIXELS_NV12 },
+		{ ofxARToolkitPlus::INPUT_I420, 1, OF_PIXELS_I420 },
+		{ ofxARToolkitPlus::INPUT_YUYV, 2, OF_PIXELS_YUY2 },
+		{ ofxARToolkitPlus::INPUT_UYVY, 2, OF_PIXELS_UYVY }
+	};
+	vector<unsigned char> frame;
+	for(size_t l=0; l<sizeof(layouts) / sizeof(layouts[0]); l++) {
+		const Layout &layout = layouts[l];
+		for(int padding=0; padding<=36; padding+=36) {
+			int stride = w * layout.bytesPerPixel + padding;
+			makeInputFrame(gray, w, h, layout.format, stride, frame);
+			ofxARToolkitPlus artk;
+			artk.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+			artk.update(ofxARToolkitPlus::InputImage(&frame[0], layout.format, padding > 0 ? stride : 0));
+			if(!TEST_CHECK(sameMarkers(expected, artk))) {
+				ofLog(OF_LOG_ERROR, "testInputImage: input format " + ofToString(layout.format) + " with " + ofToString(padding) + " bytes of padding");
+			}
+			// Stride given for packed rows
+			if(padding == 0) {
+				ofxARToolkitPlus strided;
+				strided.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+				strided.update(ofxARToolkitPlus::InputImage(&frame[0], layout.format, stride));
+				TEST_CHECK(sameMarkers(expected, strided));
+				ofxARToolkitPlus fromPixels;
+				fromPixels.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+				ofPixels pixels;
+				pixels.allocate(w, h, layout.pixelFormat);
+				memcpy(pixels.getData(), &frame[0], frame.size());
+				fromPixels.update(pixels);
+				TEST_CHECK(sameMarkers(expected, fromPixels));
+			}
+		}
+	}
+
+	// Padded color rows go through the same conversion
+	vector<unsigned char> rgb((w * 3 + 12) * h, 99);
+	for(int y=0; y<h; y++) {
+		for(int x=0; x<w; x++) {
+			memset(&rgb[y * (w * 3 + 12) + x * 3], gray[y * w + x], 3);
+		}
+	}
+	ofxARToolkitPlus color;
+	color.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+	color.update(ofxARToolkitPlus::InputImage(&rgb[0], ofxARToolkitPlus::INPUT_RGB, w * 3 + 12));
+	TEST_CHECK(sameMarkers(expected, color));
+}
@@ -0,0 +1,121 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+static void fillRect(vector<unsigned char> &pixels, int w, int x0, int y0, int x1, int y1, unsigned char value) {
+	for(int y=y0; y<y1; y++) {
+		for(int x=x0; x<x1; x++) {
+			pixels[y * w + x] = value;
+		}
+	}
+}
+
+// One pixel wide, so its pixels only touch at the corners
+static void drawDiagonal(vector<unsigned char> &pixels, int w, int x, int y, int length, int step) {
+	for(int i=0; i<length; i++) {
+		pixels[(y + i) * w + x + i * step] = 20;
+	}
+}
+
+// Same frame through both trackers, every candidate with the same area, center and corners
+static bool labelsLikeLibrary(ARToolKitPlus::TrackerMultiMarker &library, ofxARToolkitPlusTracker &tracker, const vector<unsigned char> &pixels) {
+	library.calc(&pixels[0]);
+	tracker.calc(&pixels[0]);
+	return sameMarkers(library, tracker);
+}
+
+//--------------------------------------------------
+void testLabeling() {
+	ofLog(OF_LOG_NOTICE, "testLabeling");
+	const int w = 640;
+	const int h = 480;
+
+	ARToolKitPlus::TrackerMultiMarker library(w, h, 8, 6, 6, 6, 0);
+	ofxARToolkitPlusTracker tracker(w, h, 8, 6, 6, 6, 0);
+	if(!TEST_CHECK(setupTestTracker(library) && setupTestTracker(tracker))) {
+		return;
+	}
+
+	// Busy frames: many components of every size, some of them touching the markers
+	vector<unsigned char> pixels;
+	bool same = true;
+	for(int frame=0; frame<20; frame++) {
+		vector<TestMarker> markers;
+		markers.push_back({ 480, 120 + frame * 4.0f, 130, 70, 0.3f + frame * 0.05f, 0.1f });
+		markers.push_back({ 481, 460, 160 + frame * 2.0f, 90, -0.4f, 0.15f });
+		markers.push_back({ 482, 280, 360, 60, 1.2f, 0 });
+		renderTestFrame(pixels, w, h, markers);
+		addTestBlobs(pixels, w, h, 600, 12, frame);
+		same = labelsLikeLibrary(library, tracker, pixels) && same;
+	}
+	TEST_CHECK(same);
+
+	// Components only held together at the corners of their pixels
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 150, 150, 80, 0, 0 });
+	markers.push_back({ 481, 450, 150, 80, 0, 0 });
+	renderTestFrame(pixels, w, h, markers);
+	{
+		// Squares touching corner to corner make one component, large enough to be a candidate
+		vector<unsigned char> touching = pixels;
+		fillRect(touching, w, 100, 300, 130, 330, 20);
+		fillRect(touching, w, 130, 330, 160, 360, 20);
+		fillRect(touching, w, 160, 300, 190, 330, 20);
+		// Staircases going both ways, and one ending on the border of a marker
+		drawDiagonal(touching, w, 250, 280, 150, 1);
+		drawDiagonal(touching, w, 600, 280, 150, -1);
+		drawDiagonal(touching, w, 190, 50, 50, 1);
+		TEST_CHECK(labelsLikeLibrary(library, tracker, touching));
+	}
+	{
+		// A blob touching the outer corner of a marker's border from the diagonal merges with it,
+		// one a pixel further away does not
+		vector<unsigned char> diagonal = pixels;
+		fillRect(diagonal, w, 100, 100, 110, 110, 20);
+		fillRect(diagonal, w, 491, 100, 500, 109, 20);
+		TEST_CHECK(labelsLikeLibrary(library, tracker, diagonal));
+	}
+	{
+		// Two markers whose borders touch at the corners are one component
+		vector<TestMarker> joined;
+		joined.push_back({ 480, 200, 200, 80, 0, 0 });
+		joined.push_back({ 481, 280, 280, 80, 0, 0 });
+		vector<unsigned char> joinedPixels;
+		renderTestFrame(joinedPixels, w, h, joined);
+		TEST_CHECK(labelsLikeLibrary(library, tracker, joinedPixels));
+	}
+
+	// The modes the tracker leaves to the library's own labeling must not change either
+	library.setImageProcessingMode(ARToolKitPlus::IMAGE_HALF_RES);
+	tracker.setImageProcessingMode(ARToolKitPlus::IMAGE_HALF_RES);
+	same = true;
+	for(int frame=0; frame<10; frame++) {
+		vector<TestMarker> halfMarkers;
+		halfMarkers.push_back({ 480, 150 + frame * 6.0f, 150, 120, 0.2f + frame * 0.04f, 0 });
+		halfMarkers.push_back({ 481, 450, 300, 140, -0.3f, 0.1f });
+		renderTestFrame(pixels, w, h, halfMarkers);
+		addTestBlobs(pixels, w, h, 300, 8, frame);
+		same = labelsLikeLibrary(library, tracker, pixels) && same;
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(countIdentifiedMarkers(tracker) == 2);
+	library.setImageProcessingMode(ARToolKitPlus::IMAGE_FULL_RES);
+	tracker.setImageProcessingMode(ARToolKitPlus::IMAGE_FULL_RES);
+
+	// Vignetting compensation lowers the threshold towards the corners, only arLabeling does that
+	library.activateVignettingCompensation(true, 60, 20, 20);
+	tracker.activateVignettingCompensation(true, 60, 20, 20);
+	same = true;
+	for(int frame=0; frame<10; frame++) {
+		vector<TestMarker> cornerMarkers;
+		cornerMarkers.push_back({ 480, 70, 70, 70, 0.1f * frame, 0 });
+		cornerMarkers.push_back({ 481, 570, 410, 70, 0.3f, 0 });
+		cornerMarkers.push_back({ 482, 320, 240, 70, 0.5f, 0 });
+		renderTestFrame(pixels, w, h, cornerMarkers, 160);
+		addTestBlobs(pixels, w, h, 300, 8, frame);
+		same = labelsLikeLibrary(library, tracker, pixels) && same;
+	}
+	TEST_CHECK(same);
+	library.activateVignettingCompensation(false);
+	tracker.activateVignettingCompensation(false);
+}
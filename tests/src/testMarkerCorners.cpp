@@ -0,0 +1,85 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+static bool sameCorners(const array<ofPoint, 4> &fixedCorners, const vector<ofPoint> &corners) {
+	return corners.size() == 4 && std::equal(fixedCorners.begin(), fixedCorners.end(), corners.begin());
+}
+
+//--------------------------------------------------
+void testMarkerCorners() {
+	ofLog(OF_LOG_NOTICE, "testMarkerCorners");
+	const int w = 640;
+	const int h = 480;
+	ofxARToolkitPlus artk;
+	artk.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+
+	// Turned to every direction
+	vector<TestMarker> markers;
+	for(int i=0; i<4; i++) {
+		markers.push_back({ 480 + i, 130.0f + (i % 2) * 300, 130.0f + (i / 2) * 220, 90, 0.2f + i * 1.57f, 0.1f });
+	}
+	vector<unsigned char> pixels;
+	renderTestFrame(pixels, w, h, markers);
+	artk.update(&pixels[0]);
+	int numDetected = artk.getNumDetectedMarkers();
+	TEST_CHECK(numDetected == 4);
+
+	const ARToolKitPlus::ARMarkerInfo *infos = artk.getDetectedMarkerInfos();
+	bool sameInfo = infos != NULL;
+	bool sameAsVectors = true;
+	bool cornersRight = true;
+	vector<ofPoint> corners;
+	array<ofPoint, 4> plain, ordered, border, orderedBorder;
+	for(int i=0; i<numDetected && sameInfo; i++) {
+		const ARToolKitPlus::ARMarkerInfo &marker = artk.getDetectedMarkerInfo(i);
+		sameInfo = &marker == &infos[i] && marker.id == artk.getMarkerID(i) && marker.dir == artk.getDetectedMarkerDirection(i) &&
+			artk.getDetectedMarkerCenter(i) == ofPoint(marker.pos[0], marker.pos[1]);
+
+		// The array getters write what the vector ones add
+		artk.getDetectedMarkerCorners(i, plain);
+		artk.getDetectedMarkerOrderedCorners(i, ordered);
+		artk.getDetectedMarkerBorderCorners(i, border);
+		artk.getDetectedMarkerOrderedBorderCorners(i, orderedBorder);
+		artk.getDetectedMarkerCorners(i, corners);
+		sameAsVectors = sameAsVectors && sameCorners(plain, corners);
+		artk.getDetectedMarkerOrderedCorners(i, corners);
+		sameAsVectors = sameAsVectors && sameCorners(ordered, corners);
+		artk.getDetectedMarkerBorderCorners(i, corners);
+		sameAsVectors = sameAsVectors && sameCorners(border, corners);
+		artk.getDetectedMarkerOrderedBorderCorners(i, corners);
+		sameAsVectors = sameAsVectors && sameCorners(orderedBorder, corners);
+
+		// The vertices, started at the one the direction points to, and pushed out from the center
+		ofPoint center(marker.pos[0], marker.pos[1]);
+		for(int j=0; j<4; j++) {
+			int index = (4 - marker.dir + j) % 4;
+			cornersRight = cornersRight && plain[j] == ofPoint(marker.vertex[j][0], marker.vertex[j][1]);
+			cornersRight = cornersRight && ordered[j] == plain[index];
+			cornersRight = cornersRight && border[j].distance(center + (plain[j] - center) * BORDER_SCALE) < 1e-4f;
+			cornersRight = cornersRight && orderedBorder[j] == border[index];
+		}
+	}
+	TEST_CHECK(sameInfo);
+	TEST_CHECK(sameAsVectors);
+	TEST_CHECK(cornersRight);
+
+	// Reading markers and their corners does not allocate
+	unsigned long long allocations = getNumHeapAllocations();
+	for(int i=0; i<numDetected; i++) {
+		artk.getDetectedMarkerInfo(i);
+		artk.getDetectedMarkerCenter(i);
+		artk.getDetectedMarkerCorners(i, plain);
+		artk.getDetectedMarkerOrderedCorners(i, ordered);
+		artk.getDetectedMarkerBorderCorners(i, border);
+		artk.getDetectedMarkerOrderedBorderCorners(i, orderedBorder);
+	}
+	TEST_CHECK(getNumHeapAllocations() == allocations);
+
+	// No markers, no array
+	ofxARToolkitPlus empty;
+	empty.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+	renderTestFrame(pixels, w, h, vector<TestMarker>());
+	empty.update(&pixels[0]);
+	TEST_CHECK(empty.getNumDetectedMarkers() == 0 && empty.getDetectedMarkerInfos() == NULL);
+}
@@ -0,0 +1,67 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+void testMarkerIndex() {
+	ofLog(OF_LOG_NOTICE, "testMarkerIndex");
+	const int w = 640;
+	const int h = 480;
+	ofxARToolkitPlus artk;
+	artk.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+
+	// The lowest and the highest BCH id among others
+	vector<TestMarker> markers;
+	markers.push_back({ 0, 120, 120, 90, 0.1f, 0 });
+	markers.push_back({ 480, 320, 120, 90, -0.2f, 0 });
+	markers.push_back({ 1234, 520, 120, 90, 0.3f, 0 });
+	markers.push_back({ MAX_MARKER_ID, 320, 340, 90, 0, 0.1f });
+	vector<unsigned char> pixels;
+	renderTestFrame(pixels, w, h, markers);
+	artk.update(&pixels[0]);
+	int numDetected = artk.getNumDetectedMarkers();
+	if(!TEST_CHECK(numDetected == 4)) {
+		return;
+	}
+
+	// Every detected marker is found at its index
+	bool indexed = true;
+	for(int i=0; i<numDetected; i++) {
+		indexed = indexed && artk.getMarkerIndex(artk.getMarkerID(i)) == i;
+	}
+	TEST_CHECK(indexed);
+	TEST_CHECK(artk.getMarkerIndex(0) >= 0 && artk.getMarkerIndex(MAX_MARKER_ID) >= 0);
+
+	// Markers that are not there, and ids no marker can have
+	TEST_CHECK(artk.getMarkerIndex(481) == -1);
+	TEST_CHECK(artk.getMarkerIndex(-1) == -1);
+	TEST_CHECK(artk.getMarkerIndex(MAX_MARKER_ID + 1) == -1);
+	TEST_CHECK(artk.getMarkerIndex(1 << 30) == -1);
+	TEST_CHECK(artk.getMarkerID(-1) == -1 && artk.getMarkerID(numDetected) == -1);
+
+	// Both batch lookups give the same as one lookup per id
+	const int ids[] = { 1234, -1, 0, 481, MAX_MARKER_ID + 1, MAX_MARKER_ID, 480, 1234 };
+	const int numIDs = sizeof(ids) / sizeof(ids[0]);
+	int indices[numIDs];
+	artk.getMarkerIndices(ids, numIDs, indices);
+	vector<int> indexVector(2, 7);
+	artk.getMarkerIndices(vector<int>(ids, ids + numIDs), indexVector);
+	TEST_CHECK(indexVector.size() == numIDs);
+	bool sameIndices = true;
+	for(int i=0; i<numIDs && i<(int)indexVector.size(); i++) {
+		sameIndices = sameIndices && indices[i] == artk.getMarkerIndex(ids[i]) && indexVector[i] == indices[i];
+	}
+	TEST_CHECK(sameIndices);
+	artk.getMarkerIndices(vector<int>(), indexVector);
+	TEST_CHECK(indexVector.empty());
+
+	// The index follows the next frame: markers that are gone are no longer found
+	vector<TestMarker> fewer(1, markers[2]);
+	fewer[0].x -= 200;
+	renderTestFrame(pixels, w, h, fewer);
+	for(int frame=0; frame<10 && artk.getNumDetectedMarkers() != 1; frame++) {
+		artk.update(&pixels[0]);
+	}
+	TEST_CHECK(artk.getNumDetectedMarkers() == 1);
+	TEST_CHECK(artk.getMarkerIndex(1234) == 0);
+	TEST_CHECK(artk.getMarkerIndex(0) == -1 && artk.getMarkerIndex(480) == -1 && artk.getMarkerIndex(MAX_MARKER_ID) == -1);
+}
@@ -0,0 +1,124 @@
+#include "tests.h"
+#include "testUtils.h"
+#include "ofxARToolkitPlusMultiCamera.h"
+
+//--------------------------------------------------
+// The board somewhere else in every camera, the first two see the same frame
+static void renderCameraFrame(vector<unsigned char> &pixels, int w, int h, int camera, int frame) {
+	int view = std::max(camera, 1) - 1;
+	vector<TestMarker> markers;
+	addTestBoard(markers, w / 2 + view * 12 + frame * 3, h / 2 - view * 8, 1.1f + view * 0.05f, 0.05f * view + frame * 0.01f);
+	renderTestFrame(pixels, w, h, markers);
+}
+
+//--------------------------------------------------
+void testMultiCamera() {
+	ofLog(OF_LOG_NOTICE, "testMultiCamera");
+	const int w = 640;
+	const int h = 480;
+	const int numCameras = 4;
+
+	// Every camera gives the same results as a tracker of its own
+	ofxARToolkitPlusMultiCamera multi;
+	ofxARToolkitPlus single[numCameras];
+	for(int i=0; i<numCameras; i++) {
+		TEST_CHECK(multi.addCamera(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg", 24) == i);
+		single[i].setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg", 24);
+	}
+	TEST_CHECK(multi.getNumCameras() == numCameras);
+	multi.setNumThreads(numCameras);
+	TEST_CHECK(multi.getNumThreads() == numCameras);
+	// The first two cameras sit at the world origin, only they are fused
+	multi.setCameraPose(0, ofMatrix4x4());
+	multi.setCameraPose(1, ofMatrix4x4());
+
+	vector<unsigned char> pixels[numCameras];
+	unsigned char *frames[numCameras];
+	vector<ofxARToolkitPlus::MarkerPose> poses;
+	bool samePoses = true;
+	bool sameBoard = true;
+	bool seenBoard = true;
+	for(int frame=0; frame<5; frame++) {
+		unsigned long long timestamps[numCameras];
+		for(int i=0; i<numCameras; i++) {
+			renderCameraFrame(pixels[i], w, h, i, frame);
+			frames[i] = &pixels[i][0];
+			timestamps[i] = 1000000 + frame * 33333 + i * 100;
+		}
+		multi.update(frames, timestamps);
+		const ofxARToolkitPlusMultiCamera::Tick &tick = multi.getTick();
+		TEST_CHECK(tick.tick == (unsigned long long)frame + 1);
+		TEST_CHECK(tick.timestamp == timestamps[numCameras - 1] && tick.skewMicros == (numCameras - 1) * 100);
+
+		for(int i=0; i<numCameras; i++) {
+			const ofxARToolkitPlusMultiCamera::CameraResult &result = tick.cameras[i];
+			TEST_CHECK(result.timestamp == timestamps[i]);
+			TEST_CHECK(result.confidence == single[i].update(frames[i]));
+			int numPoses = single[i].computeAllPoses(poses);
+			if(numPoses != (int)result.poses.size()) {
+				samePoses = false;
+				continue;
+			}
+			for(int j=0; j<numPoses; j++) {
+				samePoses = samePoses && result.poses[j].id == poses[j].id && result.poses[j].error == poses[j].error &&
+					memcmp(result.poses[j].matrix, poses[j].matrix, sizeof(poses[j].matrix)) == 0;
+			}
+			ofVec3f translation;
+			ofMatrix4x4 orientation;
+			single[i].getMultiMarkerTranslationAndOrientation(translation, orientation);
+			seenBoard = seenBoard && result.boardMarkers == 20 && single[i].getMultiMarkerNumVisible() == 20;
+			const float *m = orientation.getPtr();
+			sameBoard = sameBoard && result.board[0][3] == translation.x && result.board[1][3] == translation.y && result.board[2][3] == translation.z &&
+				result.board[0][0] == m[0] && result.board[1][2] == m[6];
+		}
+
+		// Both fused cameras saw the same, so the fused pose is theirs
+		const float (*board)[4] = tick.cameras[0].board;
+		bool fused = tick.fusedCameras == 2;
+		for(int r=0; r<3; r++) {
+			for(int c=0; c<4; c++) {
+				fused = fused && fabsf(tick.fusedBoard[r][c] - board[r][c]) < (c == 3 ? 1e-3f : 1e-5f);
+			}
+		}
+		TEST_CHECK(fused);
+	}
+	TEST_CHECK(samePoses);
+	TEST_CHECK(sameBoard);
+	TEST_CHECK(seenBoard);
+	ofVec3f translation;
+	ofMatrix4x4 orientation;
+	TEST_CHECK(multi.getFusedBoardTranslationAndOrientation(translation, orientation) && translation.z > 0);
+
+	// Board poses only: one RPP solve per camera instead of one per marker
+	multi.setSolveMarkerPoses(false);
+	multi.update(frames);
+	TEST_CHECK(multi.getTick().cameras[0].poses.empty() && multi.getTick().cameras[0].boardMarkers == 20);
+
+	// Only reported: how the ticks scale with threads depends on the number of cores. The pose solves
+	// (each marker's and the board's) take turns on the library lock, so they bound the speedup
+	const int numThreads[] = { 1, 2, 4 };
+	const int numFrames = 10;
+	for(int markerPoses=1; markerPoses>=0; markerPoses--) {
+		multi.setSolveMarkerPoses(markerPoses == 1);
+		unsigned long long tickMicros[3] = { 0, 0, 0 };
+		unsigned long long poseMicros = 0;
+		for(int t=0; t<3; t++) {
+			multi.setNumThreads(numThreads[t]);
+			for(int frame=0; frame<numFrames; frame++) {
+				multi.update(frames);
+				tickMicros[t] += multi.getLastUpdateMicros();
+				for(int i=0; t==0 && i<numCameras; i++) {
+					ofxARToolkitPlus &camera = multi.getCamera(i);
+					poseMicros += (markerPoses ? camera.getLastPoseSolveMicros() : 0) + camera.getLastMultiMarkerPoseMicros();
+				}
+			}
+		}
+		float serialShare = (float)poseMicros / tickMicros[0];
+		string timing = "testMultiCamera: " + ofToString(numCameras) + " cameras of 20 markers " + (markerPoses ? "with" : "without") + " marker poses took";
+		for(int t=0; t<3; t++) {
+			timing += (t > 0 ? ", " : " ") + ofToString(tickMicros[t] / numFrames) + " us on " + ofToString(numThreads[t]);
+		}
+		ofLog(OF_LOG_NOTICE, timing + " thread(s) (" + ofToString(std::thread::hardware_concurrency()) + " cores). Pose solves are " + ofToString(serialShare * 100, 0) +
+			"% of a tick, which limits 4 cores to " + ofToString(1 / (serialShare + (1 - serialShare) / 4), 1) + "x");
+	}
+}
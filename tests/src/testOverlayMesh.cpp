@@ -0,0 +1,100 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+// The four segments of a quad's outline starting at vertex first of mesh, all in one color
+static bool isQuadOutline(ofMesh &mesh, int first, const ofPoint corners[4], const ofFloatColor &color) {
+	vector<ofVec3f> &vertices = mesh.getVertices();
+	vector<ofFloatColor> &colors = mesh.getColors();
+	for(int j=0; j<4; j++) {
+		const ofPoint &start = corners[j];
+		const ofPoint &end = corners[(j + 1) % 4];
+		const ofVec3f &a = vertices[first + j * 2];
+		const ofVec3f &b = vertices[first + j * 2 + 1];
+		if(fabsf(a.x - start.x) > 1e-4f || fabsf(a.y - start.y) > 1e-4f || fabsf(b.x - end.x) > 1e-4f || fabsf(b.y - end.y) > 1e-4f) {
+			return false;
+		}
+		for(int k=0; k<2; k++) {
+			const ofFloatColor &c = colors[first + j * 2 + k];
+			if(c.r != color.r || c.g != color.g || c.b != color.b) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------
+void testOverlayMesh() {
+	ofLog(OF_LOG_NOTICE, "testOverlayMesh");
+
+	// Two markers, one of them a tilted quad
+	ARToolKitPlus::ARMarkerInfo markers[2];
+	memset(markers, 0, sizeof(markers));
+	const float vertices[2][4][2] = {
+		{ { 100, 100 }, { 140, 100 }, { 140, 140 }, { 100, 140 } },
+		{ { 300, 210 }, { 352, 200 }, { 360, 260 }, { 296, 250 } }
+	};
+	for(int i=0; i<2; i++) {
+		markers[i].id = 480 + i;
+		memcpy(markers[i].vertex, vertices[i], sizeof(vertices[i]));
+		markers[i].pos[0] = (vertices[i][0][0] + vertices[i][1][0] + vertices[i][2][0] + vertices[i][3][0]) / 4;
+		markers[i].pos[1] = (vertices[i][0][1] + vertices[i][1][1] + vertices[i][2][1] + vertices[i][3][1]) / 4;
+	}
+
+	ofMesh mesh;
+	for(int borders=0; borders<2; borders++) {
+		ofxARToolkitPlus::buildOverlayMesh(markers, 2, borders == 1, mesh);
+		// Per marker 4 lines around the center, 4 for the marker and 4 for its border
+		int perMarker = borders ? 24 : 16;
+		TEST_CHECK(mesh.getMode() == OF_PRIMITIVE_LINES);
+		TEST_CHECK((int)mesh.getNumVertices() == 2 * perMarker);
+		TEST_CHECK((int)mesh.getNumColors() == 2 * perMarker);
+		bool outlines = true;
+		for(int i=0; i<2; i++) {
+			const ARToolKitPlus::ARMarkerInfo &marker = markers[i];
+			ofPoint center(marker.pos[0], marker.pos[1]);
+			ofPoint corners[4] = { center + ofPoint(-1, -1), center + ofPoint(1, -1), center + ofPoint(1, 1), center + ofPoint(-1, 1) };
+			outlines = outlines && isQuadOutline(mesh, i * perMarker, corners, ofFloatColor(1, 0, 1));
+			for(int j=0; j<4; j++) {
+				corners[j].set(marker.vertex[j][0], marker.vertex[j][1]);
+			}
+			outlines = outlines && isQuadOutline(mesh, i * perMarker + 8, corners, ofFloatColor(1, 1, 0));
+			if(borders) {
+				for(int j=0; j<4; j++) {
+					corners[j] = center + (corners[j] - center) * BORDER_SCALE;
+				}
+				outlines = outlines && isQuadOutline(mesh, i * perMarker + 16, corners, ofFloatColor(1, 0, 0));
+			}
+		}
+		TEST_CHECK(outlines);
+	}
+
+	// Rebuilding starts over
+	ofxARToolkitPlus::buildOverlayMesh(markers, 0, true, mesh);
+	TEST_CHECK(mesh.getNumVertices() == 0 && mesh.getNumColors() == 0);
+
+	// The tracker's own mesh follows update() and setDrawBorders()
+	const int w = 640;
+	const int h = 480;
+	ofxARToolkitPlus artk;
+	artk.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+	vector<TestMarker> testMarkers;
+	testMarkers.push_back({ 480, 200, 200, 90, 0.2f, 0 });
+	testMarkers.push_back({ 481, 420, 260, 90, -0.4f, 0.1f });
+	vector<unsigned char> pixels;
+	renderTestFrame(pixels, w, h, testMarkers);
+	artk.update(&pixels[0]);
+	TEST_CHECK(artk.getNumDetectedMarkers() == 2);
+	TEST_CHECK(artk.getOverlayMesh().getNumVertices() == 2 * 16);
+	artk.setDrawBorders(true);
+	TEST_CHECK(artk.getOverlayMesh().getNumVertices() == 2 * 24);
+	// One marker moved, the other gone (the history may still add it for a few frames)
+	testMarkers[0].x += 30;
+	renderTestFrame(pixels, w, h, vector<TestMarker>(1, testMarkers[0]));
+	artk.update(&pixels[0]);
+	ofMesh overlay = artk.getOverlayMesh();
+	TEST_CHECK(artk.getNumDetectedMarkers() >= 1 && (int)overlay.getNumVertices() == artk.getNumDetectedMarkers() * 24);
+	ofPoint center = artk.getDetectedMarkerCenter(0);
+	TEST_CHECK(fabsf(overlay.getVertices()[0].x - (center.x - 1)) < 1e-4f && fabsf(overlay.getVertices()[0].y - (center.y - 1)) < 1e-4f);
+}
@@ -0,0 +1,77 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+static bool isIdentity(const ofMatrix4x4 &matrix) {
+	const float *m = matrix.getPtr();
+	for(int i=0; i<16; i++) {
+		if(m[i] != (i % 5 == 0 ? 1 : 0)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------
+void testPoseCache() {
+	ofLog(OF_LOG_NOTICE, "testPoseCache");
+	const int w = 640;
+	const int h = 480;
+	ofxARToolkitPlus artk;
+	artk.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 180, 200, 90, 0.2f, 0 });
+	markers.push_back({ 481, 440, 260, 90, -0.4f, 0.1f });
+	vector<unsigned char> pixels;
+	renderTestFrame(pixels, w, h, markers);
+	artk.update(&pixels[0]);
+	if(!TEST_CHECK(artk.getNumDetectedMarkers() == 2)) {
+		return;
+	}
+
+	// Every accessor of a marker after the first is served from the cache
+	artk.resetPoseCacheStats();
+	ofMatrix4x4 matrix = artk.getMatrix(0);
+	ofMatrix4x4 glMatrix = artk.getGLMatrix(0);
+	ofVec3f translation = artk.getTranslation(0);
+	ofMatrix4x4 orientation = artk.getOrientationMatrix(0);
+	artk.getOrientationQuaternion(0);
+	artk.getCameraPosition(0);
+	TEST_CHECK(artk.getPoseCacheMisses() == 1 && artk.getPoseCacheHits() == 5);
+	artk.getTranslation(1);
+	artk.getMatrix(1);
+	TEST_CHECK(artk.getPoseCacheMisses() == 2 && artk.getPoseCacheHits() == 6);
+
+	// All of them read the same pose
+	const float *m = matrix.getPtr();
+	const float *gl = glMatrix.getPtr();
+	const float *o = orientation.getPtr();
+	bool samePose = translation.z > 0 && m[3] == translation.x && m[7] == translation.y && m[11] == translation.z;
+	for(int r=0; r<3; r++) {
+		for(int c=0; c<4; c++) {
+			samePose = samePose && gl[c * 4 + r] == m[r * 4 + c];
+			samePose = samePose && (c == 3 || o[r * 4 + c] == m[r * 4 + c]);
+		}
+	}
+	TEST_CHECK(samePose);
+
+	// Indices of markers that were not detected get the identity and leave the counters alone
+	artk.resetPoseCacheStats();
+	TEST_CHECK(isIdentity(artk.getMatrix(-1)));
+	TEST_CHECK(isIdentity(artk.getGLMatrix(2)));
+	TEST_CHECK(isIdentity(artk.getOrientationMatrix(100)));
+	TEST_CHECK(artk.getTranslation(2).length() == 0);
+	TEST_CHECK(artk.getPoseCacheHits() == 0 && artk.getPoseCacheMisses() == 0);
+
+	// The next update() solves again, also when the markers did not move
+	artk.update(&pixels[0]);
+	ofMatrix4x4 again = artk.getMatrix(0);
+	TEST_CHECK(artk.getPoseCacheMisses() == 1 && artk.getPoseCacheHits() == 0);
+	TEST_CHECK(memcmp(again.getPtr(), matrix.getPtr(), 16 * sizeof(float)) == 0);
+	markers[0].x += 20;
+	renderTestFrame(pixels, w, h, markers);
+	artk.update(&pixels[0]);
+	int moved = artk.getMarkerIndex(480);
+	TEST_CHECK(moved >= 0 && artk.getTranslation(moved).x > translation.x);
+	TEST_CHECK(artk.getPoseCacheMisses() == 2);
+}
@@ -0,0 +1,80 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+void testPredictiveROI() {
+	ofLog(OF_LOG_NOTICE, "testPredictiveROI");
+	const int w = 640;
+	const int h = 480;
+	const int fullScanInterval = 10;
+
+	ARToolKitPlus::TrackerMultiMarker library(w, h, 8, 6, 6, 6, 0);
+	ofxARToolkitPlusTracker tracker(w, h, 8, 6, 6, 6, 0);
+	if(!TEST_CHECK(setupTestTracker(library) && setupTestTracker(tracker))) {
+		return;
+	}
+	tracker.activatePredictiveROI(true);
+	tracker.setFullScanInterval(fullScanInterval);
+
+	// Two markers moving and turning steadily, a third one showing up at frame 33.
+	// The predicted windows have to keep up with the moving ones, the new one is only
+	// looked for by the full scans
+	vector<unsigned char> pixels;
+	int firstFoundNew = -1;
+	bool sameWhileTracking = true;
+	for(int frame=0; frame<60; frame++) {
+		vector<TestMarker> markers;
+		markers.push_back({ 480, 100 + frame * 6.0f, 150 + frame * 2.0f, 70, 0.3f + frame * 0.03f, 0.1f });
+		markers.push_back({ 481, 500 - frame * 3.0f, 400, 80, -frame * 0.02f, 0 });
+		if(frame >= 33) {
+			markers.push_back({ 482, 320, 100, 60, 0.2f, 0 });
+		}
+		renderTestFrame(pixels, w, h, markers);
+		addTestBlobs(pixels, w, h, 150, 5, frame);
+		library.calc(&pixels[0]);
+		tracker.calc(&pixels[0]);
+
+		// The moving markers are found in their windows with the corners of a full scan
+		for(int id=480; id<=481; id++) {
+			const ARToolKitPlus::ARMarkerInfo *expected = findMarker(library, id);
+			const ARToolKitPlus::ARMarkerInfo *found = findMarker(tracker, id);
+			if(expected == NULL || found == NULL || found->dir != expected->dir || cornerDistance(*expected, *found) > 1e-3f) {
+				ofLog(OF_LOG_ERROR, "testPredictiveROI: marker " + ofToString(id) + " differs from the library in frame " + ofToString(frame));
+				sameWhileTracking = false;
+			}
+		}
+		if(firstFoundNew < 0 && findMarker(tracker, 482) != NULL) {
+			firstFoundNew = frame;
+		}
+	}
+	TEST_CHECK(sameWhileTracking);
+	// Most frames only searched the windows, the new marker waited for the next full scan at most
+	TEST_CHECK(tracker.getNumROIFrames() > tracker.getNumFullScanFrames());
+	TEST_CHECK(tracker.getNumFullScanFrames() >= 60 / fullScanInterval);
+	TEST_CHECK(firstFoundNew > 33 && firstFoundNew <= 33 + fullScanInterval);
+
+	// A marker that leaves gets a full scan right away, which finds the one that took its place
+	tracker.resetScanCounters();
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 150, 150, 70, 0.3f, 0 });
+	renderTestFrame(pixels, w, h, markers);
+	for(int frame=0; frame<3; frame++) {
+		tracker.calc(&pixels[0]);
+	}
+	markers[0].id = 483;
+	markers[0].x = 450;
+	renderTestFrame(pixels, w, h, markers);
+	// The history keeps reporting the lost marker for a few frames
+	for(int frame=0; frame<4; frame++) {
+		tracker.calc(&pixels[0]);
+	}
+	TEST_CHECK(findMarker(tracker, 483) != NULL);
+	TEST_CHECK(tracker.getNumFullScanFrames() >= 2);
+
+	// Turning it off goes back to full scans only
+	tracker.activatePredictiveROI(false);
+	tracker.resetScanCounters();
+	tracker.calc(&pixels[0]);
+	library.calc(&pixels[0]);
+	TEST_CHECK(tracker.getNumROIFrames() == 0);
+}
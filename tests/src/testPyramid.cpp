@@ -0,0 +1,91 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+static void testHalveImage() {
+	// Odd sizes leave out the last row and column, widths around the 32 pixel blocks of the SIMD path
+	int sizes[][2] = { { 2, 2 }, { 3, 5 }, { 31, 4 }, { 32, 6 }, { 33, 7 }, { 64, 2 }, { 97, 9 }, { 640, 480 } };
+	bool same = true;
+	for(size_t k=0; k<sizeof(sizes) / sizeof(sizes[0]); k++) {
+		int w = sizes[k][0];
+		int h = sizes[k][1];
+		vector<unsigned char> src(w * h);
+		unsigned int state = k;
+		for(size_t i=0; i<src.size(); i++) {
+			state = state * 1664525 + 1013904223;
+			src[i] = state >> 24;
+		}
+		// Saturated pixels, where the 16 bit sums are largest
+		src[0] = 255;
+		src[1] = 255;
+		src[w] = 255;
+		src[w + 1] = 255;
+		vector<unsigned char> dst((w / 2) * (h / 2));
+		ofxARToolkitPlusHalveImage(&src[0], w, h, &dst[0]);
+		for(int y=0; y<h/2; y++) {
+			for(int x=0; x<w/2; x++) {
+				const unsigned char *p = &src[(y * 2) * w + x * 2];
+				int expected = (p[0] + p[1] + p[w] + p[w + 1] + 2) / 4;
+				if(dst[y * (w / 2) + x] != expected) {
+					ofLog(OF_LOG_ERROR, "testHalveImage: " + ofToString(w) + "x" + ofToString(h) + " differs at " + ofToString(x) + ", " + ofToString(y));
+					same = false;
+					y = h;
+					break;
+				}
+			}
+		}
+	}
+	TEST_CHECK(same);
+}
+
+//--------------------------------------------------
+static void testPyramidScale(int w, int h, int scale) {
+	ARToolKitPlus::TrackerMultiMarker library(w, h, 8, 6, 6, 6, 0);
+	ofxARToolkitPlusTracker tracker(w, h, 8, 6, 6, 6, 0);
+	if(!TEST_CHECK(setupTestTracker(library) && setupTestTracker(tracker))) {
+		return;
+	}
+	tracker.setPyramidScale(scale);
+	TEST_CHECK(tracker.getPyramidScale() == scale);
+
+	// Markers large enough to show in the coarse image: the full resolution windows then find
+	// the same corners as the library, only the coarse labels decide where to look
+	float unitX = w / 640.0f;
+	float unitY = h / 480.0f;
+	float unit = std::min(unitX, unitY);
+	vector<unsigned char> pixels;
+	bool same = true;
+	for(int frame=0; frame<10; frame++) {
+		vector<TestMarker> markers;
+		markers.push_back({ 480, (120 + frame * 5) * unitX, 130 * unitY, 90 * unit, 0.3f + frame * 0.05f, 0.1f });
+		markers.push_back({ 481, 470 * unitX, (140 + frame * 3) * unitY, 110 * unit, -0.2f, 0 });
+		markers.push_back({ 482, 300 * unitX, 340 * unitY, 80 * unit, 1.1f + frame * 0.02f, 0.2f });
+		renderTestFrame(pixels, w, h, markers);
+		addTestBlobs(pixels, w, h, 300, 4, frame);
+		library.calc(&pixels[0]);
+		tracker.calc(&pixels[0]);
+		TEST_CHECK(countIdentifiedMarkers(library) == 3);
+		if(!sameMarkerCorners(library, tracker, 0.05f)) {
+			ofLog(OF_LOG_ERROR, "testPyramid: " + ofToString(w) + "x" + ofToString(h) + " at scale " + ofToString(scale) + " differs in frame " + ofToString(frame));
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+}
+
+//--------------------------------------------------
+void testPyramid() {
+	ofLog(OF_LOG_NOTICE, "testPyramid");
+	testHalveImage();
+	testPyramidScale(640, 480, 2);
+	testPyramidScale(640, 480, 4);
+	testPyramidScale(1280, 720, 2);
+	testPyramidScale(1280, 720, 4);
+	// Sizes that do not halve evenly
+	testPyramidScale(1282, 722, 4);
+
+	// Only 1, 2 and 4 are taken
+	ofxARToolkitPlusTracker tracker(640, 480, 8, 6, 6, 6, 0);
+	tracker.setPyramidScale(3);
+	TEST_CHECK(tracker.getPyramidScale() == 1);
+}
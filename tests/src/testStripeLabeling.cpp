@@ -0,0 +1,110 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+// A frame with something on every seam the stripes of 2, 4 and 8 threads have: the inner rows
+// (all but the first and the last) split evenly, at least 64 rows to a stripe
+static void renderSeamFrame(vector<unsigned char> &pixels, int w, int h, int frame) {
+	vector<TestMarker> markers;
+	int innerRows = h - 2;
+	for(int k=1; k<8; k++) {
+		int seam = 1 + innerRows * k / 8;
+		// Markers across the seams, turned so their edges cross them at an angle
+		markers.push_back({ 480 + k, 90.0f + (k % 4) * 150 + frame * 3, (float)seam + (k % 3) - 1, 70, 0.2f * k + frame * 0.03f, 0.1f });
+	}
+	renderTestFrame(pixels, w, h, markers);
+	addTestBlobs(pixels, w, h, 800, 6, frame);
+	for(int k=1; k<8; k++) {
+		int seam = 1 + innerRows * k / 8;
+		// Staircases crossing the seam, only 8-connected, going both ways
+		for(int i=-20; i<20; i++) {
+			pixels[(seam + i) * w + 30 + i + 20] = 20;
+			pixels[(seam + i) * w + w - 30 - i - 20] = 20;
+		}
+		// A component that only reaches the next stripe through one diagonal step
+		for(int x=0; x<12; x++) {
+			pixels[(seam - 1) * w + w / 2 + x] = 20;
+			pixels[seam * w + w / 2 + 12 + x] = 20;
+		}
+		// A U that joins up in the stripe below
+		for(int i=0; i<30; i++) {
+			pixels[(seam - 15 + i) * w + 560] = 20;
+			pixels[(seam - 15 + i) * w + 590] = 20;
+		}
+		for(int x=560; x<=590; x++) {
+			pixels[(seam + 15) * w + x] = 20;
+		}
+	}
+}
+
+//--------------------------------------------------
+void testStripeLabeling() {
+	ofLog(OF_LOG_NOTICE, "testStripeLabeling");
+	const int w = 640;
+	const int h = 1026;
+
+	ARToolKitPlus::TrackerMultiMarker library(w, h, 16, 6, 6, 6, 0);
+	ofxARToolkitPlusTracker serial(w, h, 16, 6, 6, 6, 0);
+	if(!TEST_CHECK(setupTestTracker(library) && setupTestTracker(serial))) {
+		return;
+	}
+	const int numThreads[] = { 2, 4, 8 };
+	ofxARToolkitPlusTracker *parallel[3];
+	for(int t=0; t<3; t++) {
+		parallel[t] = new ofxARToolkitPlusTracker(w, h, 16, 6, 6, 6, 0);
+		setupTestTracker(*parallel[t]);
+		parallel[t]->setNumLabelThreads(numThreads[t]);
+		TEST_CHECK(parallel[t]->getNumLabelThreads() == numThreads[t]);
+	}
+
+	// The stripes are joined into the same components the library finds, numbered the same way
+	vector<unsigned char> pixels;
+	bool sameAsLibrary = true;
+	bool sameAsSerial = true;
+	for(int lite=0; lite<2; lite++) {
+		library.setUseDetectLite(lite == 1);
+		serial.setUseDetectLite(lite == 1);
+		for(int t=0; t<3; t++) {
+			parallel[t]->setUseDetectLite(lite == 1);
+		}
+		for(int frame=0; frame<5; frame++) {
+			renderSeamFrame(pixels, w, h, frame);
+			library.calc(&pixels[0]);
+			serial.calc(&pixels[0]);
+			sameAsLibrary = sameMarkers(library, serial) && sameAsLibrary;
+			for(int t=0; t<3; t++) {
+				parallel[t]->calc(&pixels[0]);
+				if(!sameMarkers(serial, *parallel[t])) {
+					ofLog(OF_LOG_ERROR, "testStripeLabeling: " + ofToString(numThreads[t]) + " threads differ in frame " + ofToString(frame));
+					sameAsSerial = false;
+				}
+			}
+		}
+	}
+	TEST_CHECK(sameAsLibrary);
+	TEST_CHECK(sameAsSerial);
+	TEST_CHECK(countIdentifiedMarkers(serial) > 0);
+
+	// Only reported: the speedup depends on the number of cores
+	renderSeamFrame(pixels, w, h, 0);
+	const int numFrames = 20;
+	unsigned long long serialMicros = 0;
+	unsigned long long parallelMicros[3] = { 0, 0, 0 };
+	for(int frame=0; frame<numFrames; frame++) {
+		serial.calc(&pixels[0]);
+		serialMicros += serial.getLastLabelMicros();
+		for(int t=0; t<3; t++) {
+			parallel[t]->calc(&pixels[0]);
+			parallelMicros[t] += parallel[t]->getLastLabelMicros();
+		}
+	}
+	string timing = "testStripeLabeling: labeling " + ofToString(w) + "x" + ofToString(h) + " took " + ofToString(serialMicros / numFrames) + " us on 1 thread";
+	for(int t=0; t<3; t++) {
+		timing += ", " + ofToString(parallelMicros[t] / numFrames) + " us on " + ofToString(numThreads[t]);
+	}
+	ofLog(OF_LOG_NOTICE, timing + " (" + ofToString(std::thread::hardware_concurrency()) + " cores)");
+
+	for(int t=0; t<3; t++) {
+		delete parallel[t];
+	}
+}
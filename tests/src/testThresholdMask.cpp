@@ -0,0 +1,66 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+void testThresholdMask() {
+	ofLog(OF_LOG_NOTICE, "testThresholdMask");
+
+	// Every length up to a few words, so each SIMD width ends at every possible offset,
+	// and thresholds past both ends of the pixel range
+	const int thresholds[] = { -1, 0, 1, 85, 254, 255, 300 };
+	const uint64_t garbage = 0xa5a5a5a5a5a5a5a5ULL;
+	bool same = true;
+	bool inBounds = true;
+	for(int numPixels=0; numPixels<=200 && same; numPixels++) {
+		vector<unsigned char> src(numPixels + 1);
+		unsigned int state = numPixels;
+		for(int i=0; i<numPixels; i++) {
+			state = state * 1664525 + 1013904223;
+			src[i] = state >> 24;
+		}
+		// The extremes, where signed and unsigned compares differ
+		if(numPixels > 2) {
+			src[0] = 0;
+			src[1] = 255;
+			src[numPixels - 1] = 128;
+		}
+		int numWords = (numPixels + 63) / 64;
+		for(size_t t=0; t<sizeof(thresholds) / sizeof(thresholds[0]); t++) {
+			int threshold = thresholds[t];
+			// One word more than needed, which must be left alone
+			vector<uint64_t> mask(numWords + 1, garbage);
+			ofxARToolkitPlusThresholdMask(numPixels > 0 ? &src[0] : NULL, numPixels, threshold, &mask[0]);
+			for(int i=0; i<numWords * 64; i++) {
+				// A threshold below 0 clears the mask, like arLabeling does with no dark pixels
+				bool dark = i < numPixels && threshold >= 0 && src[i] <= threshold;
+				bool bit = (mask[i / 64] >> (i % 64)) & 1;
+				if(bit != dark) {
+					ofLog(OF_LOG_ERROR, "testThresholdMask: pixel " + ofToString(i) + " of " + ofToString(numPixels) + " at threshold " + ofToString(threshold) + " is wrong");
+					same = false;
+					break;
+				}
+			}
+			inBounds = inBounds && mask[numWords] == garbage;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(inBounds);
+
+	// A whole frame, not word aligned, against the same test pixel by pixel
+	const int w = 643;
+	const int h = 97;
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 300, 48, 60, 0.3f, 0 });
+	vector<unsigned char> pixels;
+	renderTestFrame(pixels, w, h, markers);
+	addTestBlobs(pixels, w, h, 100, 5, 1);
+	vector<uint64_t> mask((w * h + 63) / 64);
+	ofxARToolkitPlusThresholdMask(&pixels[0], w * h, 85, &mask[0]);
+	int numDark = 0;
+	int numBits = 0;
+	for(int i=0; i<w*h; i++) {
+		numDark += pixels[i] <= 85;
+		numBits += (mask[i / 64] >> (i % 64)) & 1;
+	}
+	TEST_CHECK(numDark > 0 && numBits == numDark);
+}
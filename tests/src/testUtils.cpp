@@ -0,0 +1,201 @@
+#include "testUtils.h"
+
+#include "ARToolKitPlus/arBitFieldPattern.h"
+
+static int numChecks = 0;
+static int numFailures = 0;
+
+//--------------------------------------------------
+bool testCheck(bool condition, const char *expression, const char *file, int line) {
+	numChecks++;
+	if(!condition) {
+		numFailures++;
+		ofLog(OF_LOG_ERROR, string("FAILED ") + file + ":" + ofToString(line) + ": " + expression);
+	}
+	return condition;
+}
+
+int getNumTestChecks() {
+	return numChecks;
+}
+
+int getNumTestFailures() {
+	return numFailures;
+}
+
+//--------------------------------------------------
+void renderTestFrame(vector<unsigned char> &pixels, int w, int h, const vector<TestMarker> &markers, int background) {
+	pixels.assign(w * h, background);
+	for(size_t i=0; i<markers.size(); i++) {
+		const TestMarker &marker = markers[i];
+		ARToolKitPlus::IDPATTERN pattern;
+		ARToolKitPlus::generatePatternBCH(marker.id, pattern);
+		float c = cosf(marker.angle);
+		float s = sinf(marker.angle);
+		int radius = (int)(marker.size * 1.2f) + 4;
+		for(int y=(int)marker.y-radius; y<=(int)marker.y+radius; y++) {
+			for(int x=(int)marker.x-radius; x<=(int)marker.x+radius; x++) {
+				if(x < 0 || y < 0 || x >= w || y >= h) {
+					continue;
+				}
+				// Back to the 8 x 8 cells of the marker: the border and the 6 x 6 code inside it
+				float dx = x + 0.5f - marker.x;
+				float dy = y + 0.5f - marker.y;
+				dx *= 1 + marker.tilt * dy / marker.size;
+				float u = (c * dx + s * dy) / marker.size * 8 + 4;
+				float v = (-s * dx + c * dy) / marker.size * 8 + 4;
+				if(u < -1 || v < -1 || u >= 9 || v >= 9) {
+					continue;
+				}
+				bool dark = false;
+				if(u >= 0 && v >= 0 && u < 8 && v < 8) {
+					int cu = (int)u;
+					int cv = (int)v;
+					if(cu == 0 || cv == 0 || cu == 7 || cv == 7) {
+						dark = true;
+					} else {
+						dark = !ARToolKitPlus::isBitSet(pattern, 35 - ((cv - 1) * 6 + cu - 1));
+					}
+				}
+				pixels[y * w + x] = dark ? 30 : 240;
+			}
+		}
+	}
+}
+
+void addTestBoard(vector<TestMarker> &markers, float x, float y, float pixelsPerMM, float angle) {
+	float c = cosf(angle);
+	float s = sinf(angle);
+	for(int i=0; i<20; i++) {
+		// Board coordinates have y going up, the first row is at the top
+		float bx = (-100 + (i % 5) * 50) * pixelsPerMM;
+		float by = (75 - (i / 5) * 50) * -pixelsPerMM;
+		markers.push_back({ 480 + i, x + c * bx - s * by, y + s * bx + c * by, 40 * pixelsPerMM, angle, 0 });
+	}
+}
+
+void addTestBlobs(vector<unsigned char> &pixels, int w, int h, int count, int maxSize, unsigned int seed) {
+	// A small LCG, so the frames are the same on every platform
+	unsigned int state = seed;
+	for(int i=0; i<count; i++) {
+		state = state * 1664525 + 1013904223;
+		int x = (state >> 8) % w;
+		state = state * 1664525 + 1013904223;
+		int y = (state >> 8) % h;
+		state = state * 1664525 + 1013904223;
+		int size = 1 + (state >> 8) % maxSize;
+		for(int yy=y; yy<std::min(y + size, h); yy++) {
+			for(int xx=x; xx<std::min(x + size, w); xx++) {
+				pixels[yy * w + xx] = 20;
+			}
+		}
+	}
+}
+
+//--------------------------------------------------
+bool setupTestTracker(ARToolKitPlus::TrackerMultiMarker &tracker) {
+	tracker.setPixelFormat(ARToolKitPlus::PIXEL_FORMAT_LUM);
+	tracker.setImageProcessingMode(ARToolKitPlus::IMAGE_FULL_RES);
+	if(!tracker.init(ofToDataPath("Logitech_Notebook_Pro.cal").c_str(), ofToDataPath("markerboard_480-499.cfg").c_str(), 1.0f, 1000.0f)) {
+		ofLog(OF_LOG_ERROR, "setupTestTracker: could not load the camera or board file from the data folder");
+		return false;
+	}
+	tracker.setBorderWidth(0.125f);
+	tracker.setThreshold(85);
+	tracker.setUndistortionMode(ARToolKitPlus::UNDIST_LUT);
+	tracker.setPoseEstimator(ARToolKitPlus::POSE_ESTIMATOR_RPP);
+	tracker.setMarkerMode(ARToolKitPlus::MARKER_ID_BCH);
+	tracker.setUseDetectLite(false);
+	return true;
+}
+
+//--------------------------------------------------
+float cornerDistance(const ARToolKitPlus::ARMarkerInfo &a, const ARToolKitPlus::ARMarkerInfo &b) {
+	float distance = 0;
+	for(int i=0; i<4; i++) {
+		distance = std::max(distance, std::max(fabsf(a.vertex[i][0] - b.vertex[i][0]), fabsf(a.vertex[i][1] - b.vertex[i][1])));
+	}
+	return distance;
+}
+
+static string describe(const ARToolKitPlus::ARMarkerInfo &marker) {
+	return "id " + ofToString(marker.id) + " dir " + ofToString(marker.dir) + " area " + ofToString(marker.area) +
+		" at " + ofToString(marker.pos[0]) + ", " + ofToString(marker.pos[1]);
+}
+
+static bool samePosition(float a, float b) {
+	return fabsf(a - b) <= std::max(1e-3f, fabsf(a) * 2e-6f);
+}
+
+static bool sameMarkers(const ARToolKitPlus::ARMarkerInfo *expected, int count, const ARToolKitPlus::ARMarkerInfo *actual, int actualCount) {
+	if(actualCount != count) {
+		ofLog(OF_LOG_ERROR, "sameMarkers: " + ofToString(count) + " markers expected, " + ofToString(actualCount) + " found");
+		return false;
+	}
+	bool same = true;
+	for(int i=0; i<count; i++) {
+		const ARToolKitPlus::ARMarkerInfo &a = expected[i];
+		const ARToolKitPlus::ARMarkerInfo &b = actual[i];
+		if(a.id != b.id || a.dir != b.dir || a.area != b.area || fabsf(a.cf - b.cf) > 1e-6f ||
+		   !samePosition(a.pos[0], b.pos[0]) || !samePosition(a.pos[1], b.pos[1]) || cornerDistance(a, b) > 1e-3f) {
+			ofLog(OF_LOG_ERROR, "sameMarkers: marker " + ofToString(i) + " is " + describe(b) + " instead of " + describe(a));
+			same = false;
+		}
+	}
+	return same;
+}
+
+bool sameMarkers(ARToolKitPlus::TrackerMultiMarker &expected, ARToolKitPlus::TrackerMultiMarker &actual) {
+	int count = expected.getNumDetectedMarkers();
+	int actualCount = actual.getNumDetectedMarkers();
+	return sameMarkers(count > 0 ? &expected.getDetectedMarker(0) : NULL, count, actualCount > 0 ? &actual.getDetectedMarker(0) : NULL, actualCount);
+}
+
+bool sameMarkers(ofxARToolkitPlus &expected, ofxARToolkitPlus &actual) {
+	return sameMarkers(expected.getDetectedMarkerInfos(), expected.getNumDetectedMarkers(), actual.getDetectedMarkerInfos(), actual.getNumDetectedMarkers());
+}
+
+const ARToolKitPlus::ARMarkerInfo* findMarker(ARToolKitPlus::TrackerMultiMarker &tracker, int id) {
+	for(int i=0; i<tracker.getNumDetectedMarkers(); i++) {
+		if(tracker.getDetectedMarker(i).id == id) {
+			return &tracker.getDetectedMarker(i);
+		}
+	}
+	return NULL;
+}
+
+bool sameMarkerCorners(ARToolKitPlus::TrackerMultiMarker &expected, ARToolKitPlus::TrackerMultiMarker &actual, float tolerance) {
+	bool same = true;
+	for(int i=0; i<expected.getNumDetectedMarkers(); i++) {
+		const ARToolKitPlus::ARMarkerInfo &a = expected.getDetectedMarker(i);
+		if(a.id < 0) {
+			continue;
+		}
+		const ARToolKitPlus::ARMarkerInfo *b = findMarker(actual, a.id);
+		if(b == NULL) {
+			ofLog(OF_LOG_ERROR, "sameMarkerCorners: missing " + describe(a));
+			same = false;
+		} else if(b->dir != a.dir || cornerDistance(a, *b) > tolerance) {
+			ofLog(OF_LOG_ERROR, "sameMarkerCorners: " + describe(*b) + " with corners " + ofToString(cornerDistance(a, *b)) + " pixels off instead of " + describe(a));
+			same = false;
+		}
+	}
+	for(int i=0; i<actual.getNumDetectedMarkers(); i++) {
+		const ARToolKitPlus::ARMarkerInfo &b = actual.getDetectedMarker(i);
+		if(b.id >= 0 && findMarker(expected, b.id) == NULL) {
+			ofLog(OF_LOG_ERROR, "sameMarkerCorners: unexpected " + describe(b));
+			same = false;
+		}
+	}
+	return same;
+}
+
+int countIdentifiedMarkers(ARToolKitPlus::TrackerMultiMarker &tracker) {
+	int count = 0;
+	for(int i=0; i<tracker.getNumDetectedMarkers(); i++) {
+		if(tracker.getDetectedMarker(i).id >= 0) {
+			count++;
+		}
+	}
+	return count;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxARToolkitPlus.h"
+
+/*
+ * Shared parts of the tests: checks that count failures instead of stopping the run,
+ * synthetic frames with BCH markers, and comparisons of the markers two trackers found.
+ * Most tests run ARToolKitPlus' own TrackerMultiMarker (the library path) and
+ * ofxARToolkitPlusTracker (the new path) on the same frames and compare the results.
+ */
+
+/* Count the check, and log it as failed if the condition is false. The test goes on either way */
+#define TEST_CHECK(condition) testCheck((condition), #condition, __FILE__, __LINE__)
+bool testCheck(bool condition, const char *expression, const char *file, int line);
+int getNumTestChecks();
+int getNumTestFailures();
+
+/* A BCH marker drawn into a test frame */
+struct TestMarker {
+	int id;
+	/* Center and width in pixels, black border included */
+	float x, y, size;
+	/* Rotation in radians, and how much wider the marker gets from top to bottom (a cheap tilt) */
+	float angle, tilt;
+};
+
+/* Gray w x h frame of the markers on a plain background. The markers are black (30) on white (240)
+ * with a white quiet zone of one cell around them, like printed ones */
+void renderTestFrame(vector<unsigned char> &pixels, int w, int h, const vector<TestMarker> &markers, int background = 200);
+/* Add the markers of markerboard_480-499.cfg (5 x 4 markers 40mm wide, 50mm apart) centered on x, y,
+ * at pixelsPerMM pixels to the mm and turned by angle */
+void addTestBoard(vector<TestMarker> &markers, float x, float y, float pixelsPerMM, float angle = 0);
+/* Scatter count dark squares of 1 to maxSize pixels over the frame, the same ones for the same seed */
+void addTestBlobs(vector<unsigned char> &pixels, int w, int h, int count, int maxSize, unsigned int seed);
+
+/* Set up a tracker the way ofxARToolkitPlus::setup() does, from the camera and board files in the data folder */
+bool setupTestTracker(ARToolKitPlus::TrackerMultiMarker &tracker);
+
+/* Same markers in the same order: id, direction, confidence, area, center and corners. The library adds up
+ * the centers in floats over the parts of a component, so on components far out in large frames they
+ * are only compared to a few float steps */
+bool sameMarkers(ARToolKitPlus::TrackerMultiMarker &expected, ARToolKitPlus::TrackerMultiMarker &actual);
+bool sameMarkers(ofxARToolkitPlus &expected, ofxARToolkitPlus &actual);
+/* Every identified marker of expected also in actual with the same direction and its corners at most
+ * tolerance pixels away, and no identified marker in actual that is not in expected. The order may differ */
+bool sameMarkerCorners(ARToolKitPlus::TrackerMultiMarker &expected, ARToolKitPlus::TrackerMultiMarker &actual, float tolerance);
+/* The marker of the last frame with this id, NULL if there is none */
+const ARToolKitPlus::ARMarkerInfo* findMarker(ARToolKitPlus::TrackerMultiMarker &tracker, int id);
+/* Number of markers of the last frame with an id */
+int countIdentifiedMarkers(ARToolKitPlus::TrackerMultiMarker &tracker);
+/* Largest distance between the corners of two markers, in pixels along x or y */
+float cornerDistance(const ARToolKitPlus::ARMarkerInfo &a, const ARToolKitPlus::ARMarkerInfo &b);
+
+/* Heap allocations made by the whole program so far, by any thread (countAllocations.cpp).
+ * On glibc every malloc() family call is counted, elsewhere only operator new */
+unsigned long long getNumHeapAllocations();
@@ -0,0 +1,103 @@
+#include "tests.h"
+#include "testUtils.h"
+
+//--------------------------------------------------
+// Same detected markers in both, with rotations within maxRotation of each other
+// and translations within maxTranslation mm
+static bool samePoses(ofxARToolkitPlus &expected, ofxARToolkitPlus &actual, float maxRotation, float maxTranslation) {
+	if(expected.getNumDetectedMarkers() != actual.getNumDetectedMarkers()) {
+		return false;
+	}
+	for(int i=0; i<expected.getNumDetectedMarkers(); i++) {
+		ofMatrix4x4 a = expected.getMatrix(i);
+		ofMatrix4x4 b = actual.getMatrix(i);
+		const float *ma = a.getPtr();
+		const float *mb = b.getPtr();
+		for(int r=0; r<3; r++) {
+			for(int c=0; c<4; c++) {
+				if(fabsf(ma[r * 4 + c] - mb[r * 4 + c]) > (c == 3 ? maxTranslation : maxRotation)) {
+					ofLog(OF_LOG_ERROR, "testWarmStart: marker " + ofToString(expected.getMarkerID(i)) + " differs at " + ofToString(r) + ", " + ofToString(c) +
+						": " + ofToString(mb[r * 4 + c]) + " instead of " + ofToString(ma[r * 4 + c]));
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------
+static void solveAll(ofxARToolkitPlus &artk) {
+	for(int i=0; i<artk.getNumDetectedMarkers(); i++) {
+		artk.getMatrix(i);
+	}
+}
+
+//--------------------------------------------------
+void testWarmStart() {
+	ofLog(OF_LOG_NOTICE, "testWarmStart");
+	const int w = 640;
+	const int h = 480;
+	ofxARToolkitPlus warm;
+	ofxARToolkitPlus cold;
+	warm.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+	cold.setup(w, h, "Logitech_Notebook_Pro.cal", "markerboard_480-499.cfg");
+	warm.activateWarmStartPose(true);
+	vector<TestMarker> markers;
+	markers.push_back({ 480, 160, 160, 110, 0.2f, 0.1f });
+	markers.push_back({ 481, 460, 180, 110, -0.3f, 0 });
+	markers.push_back({ 482, 320, 350, 110, 0.6f, -0.1f });
+	vector<unsigned char> pixels;
+
+	// The first frame has nothing to start from
+	vector<TestMarker> first(markers.begin(), markers.begin() + 2);
+	renderTestFrame(pixels, w, h, first);
+	warm.update(&pixels[0]);
+	cold.update(&pixels[0]);
+	solveAll(warm);
+	TEST_CHECK(warm.getPoseWarmStarts() == 0 && warm.getPoseColdStarts() == 2);
+	TEST_CHECK(samePoses(cold, warm, 0, 0));
+
+	// Moved a little: the two known markers start from their last rotation, the new one cold.
+	// The warm started poses end up close to the cold ones
+	warm.resetPoseStartStats();
+	for(size_t i=0; i<markers.size(); i++) {
+		markers[i].x += 3;
+		markers[i].angle += 0.02f;
+	}
+	renderTestFrame(pixels, w, h, markers);
+	warm.update(&pixels[0]);
+	cold.update(&pixels[0]);
+	solveAll(warm);
+	TEST_CHECK(warm.getNumDetectedMarkers() == 3);
+	TEST_CHECK(warm.getPoseWarmStarts() == 2 && warm.getPoseColdStarts() == 1);
+	TEST_CHECK(samePoses(cold, warm, 0.01f, 1));
+
+	// Markers whose pose nobody asked for have nothing to start from either
+	warm.update(&pixels[0]);
+	cold.update(&pixels[0]);
+	warm.resetPoseStartStats();
+	warm.update(&pixels[0]);
+	cold.update(&pixels[0]);
+	solveAll(warm);
+	TEST_CHECK(warm.getPoseWarmStarts() == 0 && warm.getPoseColdStarts() == 3);
+
+	// With no error small enough every warm start falls back to the same cold solve
+	warm.setWarmStartMaxError(0);
+	warm.resetPoseStartStats();
+	warm.update(&pixels[0]);
+	cold.update(&pixels[0]);
+	solveAll(warm);
+	TEST_CHECK(warm.getPoseWarmStarts() == 0 && warm.getPoseColdStarts() == 3);
+	TEST_CHECK(samePoses(cold, warm, 0, 0));
+
+	// Turned off, everything is solved cold
+	warm.setWarmStartMaxError(0.125f);
+	warm.activateWarmStartPose(false);
+	warm.resetPoseStartStats();
+	warm.update(&pixels[0]);
+	cold.update(&pixels[0]);
+	solveAll(warm);
+	TEST_CHECK(warm.getPoseWarmStarts() == 0 && warm.getPoseColdStarts() == 3);
+	TEST_CHECK(samePoses(cold, warm, 0, 0));
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+/* One function per feature, each runs its own checks (see testUtils.h) */
+void testDetectionROI();
+void testPredictiveROI();
+void testPyramid();
+void testCornerRefinement();
+void testThresholdMask();
+void testLabeling();
+void testAdaptiveThreshold();
+void testAutoThreshold();
+void testStripeLabeling();
+void testContours();
+void testFrameArena();
+void testHomography();
+void testOverlayMesh();
+void testAsync();
+void testMultiCamera();
+void testPoseCache();
+void testComputeAllPoses();
+void testWarmStart();
+void testMarkerIndex();
+void testMarkerCorners();
+void testColorInput();
+void testInputImage();